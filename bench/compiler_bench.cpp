@@ -0,0 +1,293 @@
+#include "module_generator.hpp"
+#include "module_loader.hpp"
+#include "libparser/format.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+inline void writeHelp(std::ostream& stream) {
+    stream << "Usage: compiler-bench [OPTIONS]" << std::endl
+           << "Parses and analyzes generated Oberon modules and reports throughput" << std::endl
+           << "Options:" << std::endl
+           << "  -h, --help                Show this message" << std::endl
+           << "  --baseline FILE           Compare results with FILE" << std::endl
+           << "  --update-baseline FILE    Write results to FILE" << std::endl
+           << "  --max-regression PERCENT  Fail if peak RSS grows or throughput drops more than PERCENT past the baseline;"
+           << std::endl
+           << "                            the allowed throughput drop is widened by the measured run-to-run noise" << std::endl
+           << "  --scales N,N,...          Input size multipliers (default 1,2,4,8)" << std::endl
+           << "  --iterations N            Minimum runs per input, the fastest is reported (default 5)" << std::endl
+           << "  --min-time MS             Repeat runs until they take at least MS milliseconds in total (default 500)"
+           << std::endl
+           << "  --generate DIR            Only write the generated modules to DIR" << std::endl;
+}
+
+//! Build the benchmark was compiled with, baselines are only compared within the same one
+#ifdef __OPTIMIZE__
+constexpr std::string_view build_type = "optimized";
+#else
+constexpr std::string_view build_type = "debug";
+#endif
+
+//! Fastest of the timed runs of a workload
+struct Timing {
+    double seconds;
+    //! Relative distance of the median run from the fastest one, how much a single comparison can be off
+    double noise;
+    size_t runs;
+};
+
+//! Timing of a workload and the peak RSS of the process that ran it
+struct Measurement {
+    Timing timing;
+    long peak_rss_kb;
+};
+
+struct Result {
+    std::string workload;
+    size_t scale;
+    size_t lines;
+    size_t bytes;
+    double seconds;
+    double noise;
+    long peak_rss_kb;
+
+    double lines_per_second() const { return lines / seconds; }
+    double mb_per_second() const { return bytes / seconds / (1024 * 1024); }
+    std::string key() const { return fmt::format("{}\t{}", workload, scale); }
+};
+
+std::optional<size_t> parse_size(std::string_view str) {
+    size_t value = 0;
+    auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (error != std::errc() || end != str.data() + str.size()) return std::nullopt;
+    return value;
+}
+
+std::optional<std::vector<size_t>> parse_scales(std::string_view str) {
+    std::vector<size_t> scales;
+    while (!str.empty()) {
+        auto comma = str.find(',');
+        auto value = parse_size(str.substr(0, comma));
+        if (!value || *value == 0) return std::nullopt;
+        scales.push_back(*value);
+        str = comma == std::string_view::npos ? std::string_view() : str.substr(comma + 1);
+    }
+    return scales;
+}
+
+struct BaselineEntry {
+    double lines_per_second;
+    long peak_rss_kb;
+};
+
+struct Baseline {
+    std::string build;
+    std::map<std::string, BaselineEntry> entries;
+};
+
+/*!
+ * Baseline file: a "build<TAB>type" line followed by one
+ * "workload<TAB>scale<TAB>lines per second<TAB>peak RSS KB" entry per line
+ */
+Baseline read_baseline(const std::string& path) {
+    Baseline baseline;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        auto rss_tab = line.rfind('\t');
+        if (rss_tab == std::string::npos) continue;
+        if (line.starts_with("build\t")) {
+            baseline.build = line.substr(rss_tab + 1);
+            continue;
+        }
+        auto speed_tab = line.rfind('\t', rss_tab - 1);
+        if (speed_tab == std::string::npos || speed_tab == 0) continue;
+        baseline.entries[line.substr(0, speed_tab)] = {std::stod(line.substr(speed_tab + 1, rss_tab - speed_tab - 1)),
+                                                       std::stol(line.substr(rss_tab + 1))};
+    }
+    return baseline;
+}
+
+bool write_baseline(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream file(path);
+    file << "# Regenerate with compiler-bench --update-baseline FILE from the build the benchmark runs in\n";
+    file << fmt::format("build\t{}\n", build_type);
+    file << "# workload\tscale\tlines per second\tpeak RSS KB\n";
+    for (auto& result : results)
+        file << fmt::format("{}\t{:.0f}\t{}\n", result.key(), result.lines_per_second(), result.peak_rss_kb);
+    return file.good();
+}
+
+/*!
+ * Runs the workload in a forked child so that the peak RSS reported by wait4
+ * belongs to this workload alone and not to every workload run before it.
+ * Small inputs compile in a few milliseconds, so the child repeats the runs
+ * until both the run count and the total time are reached.
+ */
+std::optional<Measurement> run_workload(ParserPtr<std::shared_ptr<nodes::IModule>> parser, const Workload& workload,
+                                        size_t iterations, double min_seconds) {
+    int fds[2];
+    if (pipe(fds) != 0) return std::nullopt;
+    auto pid = fork();
+    if (pid < 0) return std::nullopt;
+    if (pid == 0) {
+        close(fds[0]);
+        std::vector<double> times;
+        double total = 0;
+        while (times.size() < iterations || total < min_seconds) {
+            IOManager io;
+            ModuleLoader loader(parser);
+            auto start = Clock::now();
+            auto res = loader.load(io, workload.root);
+            std::chrono::duration<double> time = Clock::now() - start;
+            if (!res) _exit(1);
+            times.push_back(time.count());
+            total += time.count();
+        }
+        std::ranges::sort(times);
+        auto median = times[times.size() / 2];
+        Timing timing{times.front(), (median - times.front()) / median, times.size()};
+        auto written = write(fds[1], &timing, sizeof(timing));
+        _exit(written == sizeof(timing) ? 0 : 1);
+    }
+    close(fds[1]);
+    Timing timing{};
+    auto received = read(fds[0], &timing, sizeof(timing));
+    close(fds[0]);
+    int status = 0;
+    rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid) return std::nullopt;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || received != sizeof(timing)) return std::nullopt;
+    return Measurement{timing, usage.ru_maxrss};
+}
+
+int main(int argc, char* argv[]) {
+    std::string baseline_file, update_file, generate_dir;
+    std::vector<size_t> scales{1, 2, 4, 8};
+    size_t iterations = 5;
+    double min_seconds = 0.5;
+    std::optional<double> max_regression;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg{argv[i]};
+        if (arg == "-h" || arg == "--help") {
+            writeHelp(std::cout);
+            return 0;
+        }
+        if (i + 1 == argc) {
+            std::cerr << "Unknown option or missing value: " << arg << std::endl;
+            writeHelp(std::cerr);
+            return 1;
+        }
+        std::string_view value{argv[++i]};
+        if (arg == "--baseline") {
+            baseline_file = value;
+        } else if (arg == "--update-baseline") {
+            update_file = value;
+        } else if (arg == "--generate") {
+            generate_dir = value;
+        } else if (arg == "--max-regression") {
+            auto percent = parse_size(value);
+            if (!percent) return std::cerr << "Invalid percent: " << value << std::endl, 1;
+            max_regression = *percent / 100.0;
+        } else if (arg == "--scales") {
+            auto res = parse_scales(value);
+            if (!res) return std::cerr << "Invalid scales: " << value << std::endl, 1;
+            scales = *res;
+        } else if (arg == "--iterations") {
+            auto res = parse_size(value);
+            if (!res || *res == 0) return std::cerr << "Invalid iterations: " << value << std::endl, 1;
+            iterations = *res;
+        } else if (arg == "--min-time") {
+            auto res = parse_size(value);
+            if (!res) return std::cerr << "Invalid time: " << value << std::endl, 1;
+            min_seconds = *res / 1000.0;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            writeHelp(std::cerr);
+            return 1;
+        }
+    }
+
+    if (!generate_dir.empty()) {
+        fs::create_directories(generate_dir);
+        for (auto scale : scales) {
+            auto dir = fs::path(generate_dir) / fmt::format("scale{}", scale);
+            fs::create_directories(dir);
+            for (auto& workload : generator::workloads(scale)) generator::write(dir, workload.modules);
+        }
+        return 0;
+    }
+
+    auto baseline = baseline_file.empty() ? Baseline() : read_baseline(baseline_file);
+    if (!baseline.entries.empty() && baseline.build != build_type) {
+        std::cerr << fmt::format("Baseline build type is {} and this build is {}, not comparing\n",
+                                 baseline.build.empty() ? "unknown" : baseline.build, build_type);
+        baseline.entries.clear();
+    }
+    // Modules are looked up relative to the working directory
+    auto work_dir = fs::temp_directory_path() / fmt::format("oberon-bench-{}", getpid());
+    auto old_dir = fs::current_path();
+    auto parser = get_parsers();
+    std::vector<Result> results;
+    bool failed = false;
+
+    std::cout << fmt::format("{:<18} {:>6} {:>9} {:>12} {:>6} {:>7} {:>12} {:>9} {:>12} {:>10} {:>10}\n", "workload", "scale",
+                             "lines", "time (ms)", "runs", "noise", "lines/s", "MB/s", "peak RSS KB", "baseline", "RSS");
+    for (auto scale : scales) {
+        for (auto& workload : generator::workloads(scale)) {
+            auto dir = work_dir / fmt::format("scale{}", scale);
+            fs::create_directories(dir);
+            generator::write(dir, workload.modules);
+            fs::current_path(dir);
+            auto measurement = run_workload(parser, workload, iterations, min_seconds);
+            fs::current_path(old_dir);
+            if (!measurement) {
+                std::cerr << fmt::format("Workload '{}' at scale {} failed to compile\n", workload.name, scale);
+                failed = true;
+                continue;
+            }
+            auto& timing = measurement->timing;
+            Result result{workload.name, scale, workload.lines(), workload.bytes(), timing.seconds, timing.noise,
+                          measurement->peak_rss_kb};
+            std::string speed_comparison = "-";
+            std::string rss_comparison = "-";
+            if (auto it = baseline.entries.find(result.key()); it != baseline.entries.end()) {
+                double speed_ratio = result.lines_per_second() / it->second.lines_per_second;
+                double rss_ratio = double(result.peak_rss_kb) / it->second.peak_rss_kb;
+                speed_comparison = fmt::format("{:+.1f}%", (speed_ratio - 1) * 100);
+                rss_comparison = fmt::format("{:+.1f}%", (rss_ratio - 1) * 100);
+                // A drop within the noise of this measurement is not reported as a regression
+                if (max_regression && speed_ratio < 1 - *max_regression - result.noise) {
+                    speed_comparison = format_red(speed_comparison);
+                    failed = true;
+                }
+                if (max_regression && rss_ratio > 1 + *max_regression) {
+                    rss_comparison = format_red(rss_comparison);
+                    failed = true;
+                }
+            }
+            std::cout << fmt::format("{:<18} {:>6} {:>9} {:>12.3f} {:>6} {:>6.1f}% {:>12.0f} {:>9.2f} {:>12} {:>10} {:>10}\n",
+                                     result.workload, scale, result.lines, result.seconds * 1000, timing.runs,
+                                     result.noise * 100, result.lines_per_second(), result.mb_per_second(),
+                                     result.peak_rss_kb, speed_comparison, rss_comparison);
+            results.push_back(result);
+        }
+    }
+    fs::remove_all(work_dir);
+
+    if (!update_file.empty() && !write_baseline(update_file, results)) {
+        std::cerr << fmt::format("Can't write baseline file '{}'\n", update_file);
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+#include "module_generator.hpp"
+#include "fmt/format.h"
+#include <algorithm>
+#include <fstream>
+
+size_t Workload::lines() const {
+    size_t result = 0;
+    for (auto& module : modules) result += std::ranges::count(module.text, '\n');
+    return result;
+}
+
+size_t Workload::bytes() const {
+    size_t result = 0;
+    for (auto& module : modules) result += module.text.size();
+    return result;
+}
+
+inline std::string nested_expression(size_t depth, size_t seed) {
+    static const char* operators[] = {"+", "*", "-", "DIV"};
+    std::string result = "i";
+    for (size_t level = 0; level < depth; ++level)
+        result = fmt::format("({} {} {})", result, operators[(level + seed) % 4], level % 7 + 1);
+    return result;
+}
+
+GeneratedModule generator::deep_expressions(std::string name, size_t depth, size_t count) {
+    fmt::memory_buffer out;
+    fmt::format_to(out, "MODULE {};\nVAR i, j: INTEGER;\nBEGIN\n  i := 1;\n", name);
+    for (size_t n = 0; n < count; ++n) fmt::format_to(out, "  j := {};\n", nested_expression(depth, n));
+    fmt::format_to(out, "  i := j\nEND {}.\n", name);
+    return {name, fmt::to_string(out)};
+}
+
+GeneratedModule generator::record_hierarchy(std::string name, size_t depth, size_t width) {
+    fmt::memory_buffer out;
+    fmt::format_to(out, "MODULE {};\nTYPE\n", name);
+    for (size_t level = 0; level < depth; ++level) {
+        if (level == 0)
+            fmt::format_to(out, "  R0 = RECORD\n");
+        else
+            fmt::format_to(out, "  R{} = RECORD (R{})\n", level, level - 1);
+        for (size_t field = 0; field < width; ++field)
+            fmt::format_to(out, "    f{}x{}: INTEGER{}\n", level, field, field + 1 < width ? ";" : "");
+        fmt::format_to(out, "  END;\n");
+    }
+    fmt::format_to(out, "  P = POINTER TO R{};\n", depth - 1);
+    fmt::format_to(out, "VAR r: R{}; p: P; i: INTEGER;\nBEGIN\n  NEW(p);\n  i := 0;\n", depth - 1);
+    for (size_t level = 0; level < depth; ++level) {
+        for (size_t field = 0; field < width; ++field)
+            fmt::format_to(out, "  r.f{0}x{1} := i; p.f{0}x{1} := r.f{0}x{1} + {2};\n", level, field, level);
+    }
+    fmt::format_to(out, "  i := r.f0x0\nEND {}.\n", name);
+    return {name, fmt::to_string(out)};
+}
+
+GeneratedModule generator::procedures(std::string name, size_t count) {
+    fmt::memory_buffer out;
+    fmt::format_to(out, "MODULE {};\nVAR i, j: INTEGER;\n\n", name);
+    for (size_t n = 0; n < count; ++n) {
+        fmt::format_to(out,
+                       "PROCEDURE P{0}(a, b: INTEGER): INTEGER;\n"
+                       "VAR t, k: INTEGER;\n"
+                       "BEGIN\n"
+                       "  t := a + b * {0};\n"
+                       "  FOR k := 0 TO 10 DO\n"
+                       "    IF t > {0} THEN t := t - k ELSIF t < 0 THEN t := -t ELSE t := t + 1 END\n"
+                       "  END;\n"
+                       "  WHILE t > 100 DO t := t DIV 2 END\n"
+                       "RETURN t\n"
+                       "END P{0};\n\n",
+                       n);
+    }
+    fmt::format_to(out, "BEGIN\n  i := 0;\n");
+    for (size_t n = 0; n < count; ++n) fmt::format_to(out, "  j := P{}(i, {});\n", n, n);
+    fmt::format_to(out, "  i := j\nEND {}.\n", name);
+    return {name, fmt::to_string(out)};
+}
+
+GeneratedModule generator::case_statement(std::string name, size_t labels) {
+    fmt::memory_buffer out;
+    fmt::format_to(out, "MODULE {};\nVAR i, j: INTEGER;\nBEGIN\n  i := 0;\n  CASE i OF\n", name);
+    for (size_t n = 0; n < labels; ++n) {
+        if (n % 4 == 3)
+            fmt::format_to(out, "  | {}..{}: j := {}\n", 2 * n, 2 * n + 1, n);
+        else
+            fmt::format_to(out, "  {}{}: j := {}\n", n == 0 ? "" : "| ", 2 * n, n);
+    }
+    fmt::format_to(out, "  END\nEND {}.\n", name);
+    return {name, fmt::to_string(out)};
+}
+
+std::vector<GeneratedModule> generator::import_chain(std::string name, size_t length) {
+    std::vector<GeneratedModule> modules;
+    for (size_t n = 0; n < length; ++n) {
+        auto module = n + 1 == length ? name : fmt::format("{}{}", name, n);
+        fmt::memory_buffer out;
+        fmt::format_to(out, "MODULE {};\n", module);
+        if (n > 0) fmt::format_to(out, "IMPORT {};\n", modules.back().name);
+        // Each Item extends the one of the imported module, so value and size come from the first module
+        auto prev = n > 0 ? modules.back().name : std::string();
+        fmt::format_to(out,
+                       "CONST Size* = {0};\n"
+                       "TYPE Item* = {1};\n"
+                       "VAR counter*: INTEGER; item: Item;{2}\n"
+                       "PROCEDURE Get*(): INTEGER;\n"
+                       "RETURN Size\n"
+                       "END Get;\n",
+                       n + 1,
+                       n > 0 ? fmt::format("RECORD ({}.Item) level{}*: INTEGER END", prev, n)
+                             : "RECORD value*, size*: INTEGER END",
+                       n > 0 ? fmt::format(" prev: {}.Item;", prev) : "");
+        if (n > 0) {
+            fmt::format_to(out,
+                           "BEGIN\n"
+                           "  prev.value := {0}.counter + {0}.Get();\n"
+                           "  item.value := prev.value + {0}.Size;\n"
+                           "  item.level{1} := item.size;\n"
+                           "  counter := item.value\n",
+                           prev, n);
+        }
+        fmt::format_to(out, "END {}.\n", module);
+        modules.push_back({module, fmt::to_string(out)});
+    }
+    return modules;
+}
+
+GeneratedModule generator::multimethods(std::string name, size_t cases) {
+    fmt::memory_buffer out;
+    fmt::format_to(out, "MODULE {};\nTYPE\n  R0 = RECORD a: INTEGER END;\n", name);
+    for (size_t n = 1; n < cases; ++n) fmt::format_to(out, "  R{} = RECORD (R0) f{}: INTEGER END;\n", n, n);
+    fmt::format_to(out, "  Shape = CASE OF");
+    for (size_t n = 0; n < cases; ++n) fmt::format_to(out, "{} c{}: R{}", n == 0 ? "" : " |", n, n);
+    fmt::format_to(out, " END;\nVAR i: INTEGER;\n\n"
+                        "PROCEDURE Area {{s: Shape}} (k: INTEGER): INTEGER;\nRETURN 0\nEND Area;\n\n");
+    for (size_t n = 0; n < cases; ++n)
+        fmt::format_to(out, "PROCEDURE Area {{s: Shape<c{0}>}} (k: INTEGER): INTEGER;\nRETURN k * {0}\nEND Area;\n\n", n);
+    fmt::format_to(out, "BEGIN\n  i := 0\nEND {}.\n", name);
+    return {name, fmt::to_string(out)};
+}
+
+GeneratedModule generator::nested_parentheses(std::string name, size_t depth) {
+    auto text = fmt::format("MODULE {0};\nVAR i, j: INTEGER;\nBEGIN\n  j := {1}i{2}\nEND {0}.\n", name,
+                            std::string(depth, '('), std::string(depth, ')'));
+    return {name, std::move(text)};
+}
+
+GeneratedModule generator::elsif_chain(std::string name, size_t length) {
+    fmt::memory_buffer out;
+    fmt::format_to(out, "MODULE {};\nVAR i, j: INTEGER;\nBEGIN\n  i := 0;\n  IF i = 0 THEN j := 0\n", name);
+    for (size_t n = 1; n <= length; ++n) fmt::format_to(out, "  ELSIF i = {0} THEN j := {0}\n", n);
+    fmt::format_to(out, "  END\nEND {}.\n", name);
+    return {name, fmt::to_string(out)};
+}
+
+GeneratedModule generator::nested_calls(std::string name, size_t depth) {
+    fmt::memory_buffer out;
+    fmt::format_to(out, "MODULE {};\nVAR j: INTEGER;\n", name);
+    fmt::format_to(out, "PROCEDURE F(a: INTEGER): INTEGER;\nRETURN a\nEND F;\n");
+    std::string open, close;
+    for (size_t n = 0; n < depth; ++n) {
+        open += "F(";
+        close += ")";
+    }
+    fmt::format_to(out, "BEGIN\n  j := {}0{}\nEND {}.\n", open, close, name);
+    return {name, fmt::to_string(out)};
+}
+
+GeneratedModule generator::long_expression(std::string name, size_t terms) {
+    static const char* operators[] = {" + ", " * ", " - ", " DIV "};
+    fmt::memory_buffer out;
+    fmt::format_to(out, "MODULE {};\nVAR i, j: INTEGER;\nBEGIN\n  i := 1;\n  j := i", name);
+    for (size_t n = 1; n < terms; ++n) fmt::format_to(out, "{}{}", operators[n % 4], n % 2 == 0 ? "i" : "2");
+    fmt::format_to(out, "\nEND {}.\n", name);
+    return {name, fmt::to_string(out)};
+}
+
+std::vector<Workload> generator::workloads(size_t scale) {
+    std::vector<Workload> result;
+    auto single = [&result](std::string name, GeneratedModule module) {
+        auto root = module.name;
+        result.push_back({std::move(name), root, {std::move(module)}});
+    };
+    single("deep expressions", deep_expressions("Expressions", 16, 50 * scale));
+    single("record hierarchy", record_hierarchy("Records", 8 * scale, 8));
+    single("procedures", procedures("Procedures", 50 * scale));
+    single("case statement", case_statement("Cases", 200 * scale));
+    result.push_back({"import chain", "Chain", import_chain("Chain", 10 * scale)});
+    single("multimethods", multimethods("Methods", 10 * scale));
+    return result;
+}
+
+void generator::write(const fs::path& dir, const std::vector<GeneratedModule>& modules) {
+    for (auto& module : modules) {
+        std::ofstream file(dir / (module.name + ".Mod"));
+        file << module.text;
+    }
+}
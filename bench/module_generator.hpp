@@ -0,0 +1,54 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+//! Synthetic Oberon-07 source used by the benchmarks
+struct GeneratedModule {
+    std::string name;
+    std::string text;
+};
+
+//! Set of modules compiled together, starting from the root module
+struct Workload {
+    std::string name;
+    std::string root;
+    std::vector<GeneratedModule> modules;
+
+    size_t lines() const;
+    size_t bytes() const;
+};
+
+namespace generator {
+
+//! Assignments whose right-hand sides are parenthesized expressions nested \p depth levels deep
+GeneratedModule deep_expressions(std::string name, size_t depth, size_t count);
+//! Chains of records, each extending the previous one with \p width new fields
+GeneratedModule record_hierarchy(std::string name, size_t depth, size_t width);
+//! \p count independent procedures with local variables and control flow
+GeneratedModule procedures(std::string name, size_t count);
+//! One CASE statement with \p labels integer labels
+GeneratedModule case_statement(std::string name, size_t labels);
+//! \p length modules, each importing the previous one; the last is named \p name
+std::vector<GeneratedModule> import_chain(std::string name, size_t length);
+//! Common type with \p cases variants and a multimethod instance for every variant
+GeneratedModule multimethods(std::string name, size_t cases);
+
+//! Assignment of an expression wrapped in \p depth pairs of parentheses
+GeneratedModule nested_parentheses(std::string name, size_t depth);
+//! IF statement with \p length ELSIF branches
+GeneratedModule elsif_chain(std::string name, size_t length);
+//! Function calls nested \p depth deep; every level first tries the alternatives that fail late
+GeneratedModule nested_calls(std::string name, size_t depth);
+//! Single expression with \p terms operands
+GeneratedModule long_expression(std::string name, size_t terms);
+
+//! All of the above with sizes proportional to \p scale
+std::vector<Workload> workloads(size_t scale);
+
+void write(const fs::path& dir, const std::vector<GeneratedModule>& modules);
+
+} // namespace generator
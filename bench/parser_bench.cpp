@@ -0,0 +1,124 @@
+#include "parsers.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+
+using Clock = std::chrono::steady_clock;
+
+// The benchmark depends on libparser alone, so it counts allocations itself
+// instead of linking the compiler's alloc_stats
+namespace {
+
+size_t g_allocations = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (auto ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+inline void writeHelp(std::ostream& stream) {
+    stream << "Usage: parser-bench [OPTIONS] [COMBINATOR...]" << std::endl
+           << "Runs libparser combinators over synthetic inputs and reports ns/byte and allocations/byte" << std::endl
+           << "Options:" << std::endl
+           << "  -h, --help        Show this message" << std::endl
+           << "  --size BYTES      Input size (default 1000000)" << std::endl
+           << "  --iterations N    Runs per combinator, the fastest is reported (default 5)" << std::endl;
+}
+
+//! One measured combinator: the input is \p unit repeated up to the requested size
+struct Case {
+    std::string name;
+    std::string unit;
+    std::function<bool(CodeIterator&)> run;
+};
+
+template <class T>
+inline std::function<bool(CodeIterator&)> runner(ParserPtr<T> parser) {
+    return [parser](CodeIterator& stream) { return parser->parse(stream).has_value(); };
+}
+
+std::vector<Case> make_cases() {
+    auto letter = predicate("letter", [](char c) { return c >= 'a' && c <= 'z'; });
+    auto digit = predicate("digit", [](char c) { return c >= '0' && c <= '9'; });
+    auto number = extension(some(digit), [](const std::vector<char>& digits) {
+        int value = 0;
+        for (auto c : digits) value = value * 10 + (c - '0');
+        return value;
+    });
+    return {
+        {"many", "a", runner(many(symbol('a')))},
+        {"chain", "a", runner(chain(letter, many(letter)))},
+        {"Sequence", "abc", runner(many(sequence(symbol('a'), symbol('b'), symbol('c'))))},
+        // Every element matches only the last alternative
+        {"Either", "d", runner(many(either({symbol('a'), symbol('b'), symbol('c'), symbol('d')})))},
+        {"Select", "(a)", runner(many(parse_index<1>::select(symbol('('), letter, symbol(')'))))},
+        {"Extension", "12345,", runner(many(parse_index<0>::select(number, symbol(','))))},
+        // The first alternative consumes 7 bytes before failing and is rolled back
+        {"BreakPoint rollback", "abcdefgh",
+         runner(many(either({parse_index<0>::select(symbols("abcdefg"), symbol('X')),
+                             parse_index<0>::select(symbols("abcdefg"), symbol('h'))})))},
+    };
+}
+
+int main(int argc, char* argv[]) {
+    size_t size = 1000000;
+    size_t iterations = 5;
+    std::vector<std::string_view> filter;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg{argv[i]};
+        if (arg == "-h" || arg == "--help") {
+            writeHelp(std::cout);
+            return 0;
+        } else if ((arg == "--size" || arg == "--iterations") && i + 1 < argc) {
+            auto value = std::strtoull(argv[++i], nullptr, 10);
+            if (value == 0) return std::cerr << "Invalid value for " << arg << std::endl, 1;
+            (arg == "--size" ? size : iterations) = value;
+        } else if (arg.starts_with("-")) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            writeHelp(std::cerr);
+            return 1;
+        } else {
+            filter.push_back(arg);
+        }
+    }
+
+    std::cout << fmt::format("{:<22} {:>10} {:>10} {:>12} {:>10}\n", "combinator", "bytes", "ns/byte", "allocs/byte",
+                             "MB/s");
+    bool failed = false;
+    for (auto& test : make_cases()) {
+        if (!filter.empty() && std::ranges::find(filter, test.name) == filter.end()) continue;
+        std::string input;
+        while (input.size() + test.unit.size() <= size) input += test.unit;
+
+        double best = 0;
+        size_t allocations = 0;
+        for (size_t i = 0; i < iterations; ++i) {
+            CodeIterator stream(input);
+            auto before = g_allocations;
+            auto start = Clock::now();
+            bool success = test.run(stream);
+            std::chrono::duration<double> time = Clock::now() - start;
+            allocations = g_allocations - before;
+            if (!success || stream.place().get_index() != input.size()) {
+                std::cerr << fmt::format("Combinator '{}' stopped at byte {} of {}\n", test.name,
+                                         stream.place().get_index(), input.size());
+                failed = true;
+                break;
+            }
+            if (i == 0 || time.count() < best) best = time.count();
+        }
+        if (best == 0) continue;
+        std::cout << fmt::format("{:<22} {:>10} {:>10.2f} {:>12.3f} {:>10.1f}\n", test.name, input.size(),
+                                 best * 1e9 / input.size(), double(allocations) / input.size(),
+                                 input.size() / best / (1024 * 1024));
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+#include "module_generator.hpp"
+#include "parser.hpp"
+#include "libparser/format.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+inline void writeHelp(std::ostream& stream) {
+    stream << "Usage: scaling-bench [OPTIONS] [CONSTRUCT...]" << std::endl
+           << "Parses pathological inputs at doubling sizes and fails if parse time grows faster than allowed."
+           << std::endl
+           << "A size that crashes the parser, e.g. by exhausting the stack, is reported as its limit." << std::endl
+           << "Options:" << std::endl
+           << "  -h, --help             Show this message" << std::endl
+           << "  --max-exponent X       Largest accepted exponent of the fitted time ~ size^X curve (default 1.3)"
+           << std::endl
+           << "  --doublings N          Number of input sizes (default 6)" << std::endl;
+}
+
+//! Input family whose size is doubled starting from \p start
+struct Construct {
+    std::string name;
+    size_t start;
+    std::function<GeneratedModule(size_t)> generate;
+};
+
+struct Sample {
+    size_t bytes;
+    double seconds;
+};
+
+//! Result of measuring one input in a forked child
+struct Outcome {
+    std::optional<double> seconds; //!< Empty if the input could not be parsed
+    int signal = 0;                //!< Signal that killed the child, 0 if it exited
+};
+
+std::vector<Construct> make_constructs() {
+    return {
+        {"nested parentheses", 64, [](size_t n) { return generator::nested_parentheses("Parens", n); }},
+        {"elsif chain", 256, [](size_t n) { return generator::elsif_chain("Elsif", n); }},
+        // The parser recurses per nesting level: a debug build with an 8 MB stack overflows it between
+        // 512 and 1024 nested calls, which shows up as the recursion limit of this construct
+        {"nested calls", 32, [](size_t n) { return generator::nested_calls("Calls", n); }},
+        {"long expression", 256, [](size_t n) { return generator::long_expression("Expression", n); }},
+    };
+}
+
+//! Average parse time, repeated until the measurement is long enough to be stable
+std::optional<double> measure(ParserPtr<std::shared_ptr<nodes::IModule>> parser, const std::string& text) {
+    using namespace std::chrono_literals;
+    size_t runs = 0;
+    auto start = Clock::now();
+    do {
+        CodeIterator stream(text);
+        if (!parser->parse(stream)) return std::nullopt;
+        runs++;
+    } while (Clock::now() - start < 20ms);
+    return std::chrono::duration<double>(Clock::now() - start).count() / runs;
+}
+
+//! Runs measure() in a forked child, so that a parser crash on a deep input ends only this measurement
+Outcome measure_isolated(ParserPtr<std::shared_ptr<nodes::IModule>> parser, const std::string& text) {
+    int fds[2];
+    if (pipe(fds) != 0) return {};
+    auto pid = fork();
+    if (pid < 0) return {};
+    if (pid == 0) {
+        close(fds[0]);
+        auto time = measure(parser, text);
+        if (!time) _exit(1);
+        auto written = write(fds[1], &*time, sizeof(*time));
+        _exit(written == sizeof(*time) ? 0 : 1);
+    }
+    close(fds[1]);
+    double time = 0;
+    auto received = read(fds[0], &time, sizeof(time));
+    close(fds[0]);
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid) return {};
+    if (WIFSIGNALED(status)) return {std::nullopt, WTERMSIG(status)};
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || received != sizeof(time)) return {};
+    return {time};
+}
+
+//! Least squares slope of log(time) over log(size)
+double fit_exponent(const std::vector<Sample>& samples) {
+    double n = samples.size(), sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (auto& sample : samples) {
+        double x = std::log(sample.bytes), y = std::log(sample.seconds);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+int main(int argc, char* argv[]) {
+    double max_exponent = 1.3;
+    size_t doublings = 6;
+    std::vector<std::string_view> filter;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg{argv[i]};
+        if (arg == "-h" || arg == "--help") {
+            writeHelp(std::cout);
+            return 0;
+        } else if (arg == "--max-exponent" && i + 1 < argc) {
+            max_exponent = std::strtod(argv[++i], nullptr);
+            if (max_exponent <= 0) return std::cerr << "Invalid exponent: " << argv[i] << std::endl, 1;
+        } else if (arg == "--doublings" && i + 1 < argc) {
+            doublings = std::strtoull(argv[++i], nullptr, 10);
+            if (doublings < 2) return std::cerr << "At least 2 sizes are required" << std::endl, 1;
+        } else if (arg.starts_with("-")) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            writeHelp(std::cerr);
+            return 1;
+        } else {
+            filter.push_back(arg);
+        }
+    }
+
+    auto parser = get_parsers();
+    bool failed = false;
+    for (auto& construct : make_constructs()) {
+        if (!filter.empty() && std::ranges::find(filter, construct.name) == filter.end()) continue;
+        std::cout << format_color(Blue, construct.name) << "\n";
+        std::cout << fmt::format("{:>10} {:>10} {:>12} {:>10}\n", "size", "bytes", "time (ms)", "ns/byte");
+        std::vector<Sample> samples;
+        for (size_t step = 0, size = construct.start; step < doublings; ++step, size *= 2) {
+            auto module = construct.generate(size);
+            auto outcome = measure_isolated(parser, module.text);
+            if (outcome.signal != 0) {
+                // Not a regression of the parse time: the fit uses the sizes below the limit
+                std::cout << fmt::format("{:>10} {:>10} parser crashed ({}), recursion limit is between {} and {}\n",
+                                         size, module.text.size(), strsignal(outcome.signal), size / 2, size);
+                break;
+            }
+            if (!outcome.seconds) {
+                std::cerr << fmt::format("Can't parse '{}' of size {}\n", construct.name, size);
+                failed = true;
+                break;
+            }
+            auto time = outcome.seconds;
+            samples.push_back({module.text.size(), *time});
+            std::cout << fmt::format("{:>10} {:>10} {:>12.3f} {:>10.1f}\n", size, module.text.size(), *time * 1e3,
+                                     *time * 1e9 / module.text.size());
+        }
+        if (samples.size() < 2) continue;
+        auto exponent = fit_exponent(samples);
+        auto verdict = exponent > max_exponent ? format_red("FAIL") : format_color(Green, "ok");
+        std::cout << fmt::format("exponent {:.2f} (limit {:.2f}) {}\n\n", exponent, max_exponent, verdict);
+        failed = failed || exponent > max_exponent;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+//! Counters maintained by the global operator new/delete interposition
+struct AllocCounters {
+    size_t allocations = 0;
+    size_t bytes = 0;
+    size_t live = 0;
+    size_t peak = 0;
+};
+
+namespace alloc_stats {
+
+//! True when the compiler was built with the counting allocator (meson -Dalloc_stats=true)
+bool enabled() noexcept;
+
+AllocCounters counters() noexcept;
+
+//! Restarts peak tracking from the current live size and returns the previous peak
+size_t restart_peak() noexcept;
+
+//! Restores an outer peak after a nested measurement
+void merge_peak(size_t peak) noexcept;
+
+} // namespace alloc_stats
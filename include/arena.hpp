@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+/*!
+ * Per-module arena. Blocks are cut from a monotonic buffer, deallocation only
+ * updates the statistics and everything is released at once when the arena
+ * is destroyed. Addresses are never reused while the arena lives, which the
+ * identity caches of the TypeInterner rely on: they are keyed by node and
+ * scope addresses without owning them, so a freed node must not be replaced
+ * by another one at the same address.
+ *
+ * The arena is never installed as the default std::pmr resource: only
+ * make_optr, ArenaAllocated and the symbol containers (through
+ * node_resource()) and libparser (through the CodeIterator resource) allocate
+ * from it. Nothing allocated from an arena may outlive it, so no node, type
+ * or table of a loaded module may outlive its ModuleLoader. The destructor
+ * asserts that every block has been returned.
+ */
+class Arena : public std::pmr::memory_resource {
+  public:
+    static constexpr size_t initial_block_size = 64 * 1024;
+
+    Arena() : m_buffer(initial_block_size, std::pmr::new_delete_resource()) {}
+    ~Arena() { assert(m_live == 0 && "object allocated from a module arena outlives it"); }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    size_t allocations() const noexcept { return m_allocations; }
+    //! Total of all allocations, the size of the arena as freed blocks are not reused
+    size_t bytes() const noexcept { return m_bytes; }
+
+    //! Arena of the innermost ArenaScope, or nullptr
+    static Arena* current() noexcept { return s_current; }
+
+  private:
+    friend class ArenaScope;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        m_allocations++;
+        m_live++;
+        m_bytes += bytes;
+        return m_buffer.allocate(bytes, alignment);
+    }
+    void do_deallocate(void*, size_t, size_t) override { m_live--; }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    static inline thread_local Arena* s_current = nullptr;
+
+    std::pmr::monotonic_buffer_resource m_buffer;
+    size_t m_allocations = 0;
+    size_t m_live = 0;
+    size_t m_bytes = 0;
+};
+
+//! Makes an arena the one returned by node_resource() until the end of the scope
+class ArenaScope {
+  public:
+    explicit ArenaScope(Arena& arena) : m_previous(std::exchange(Arena::s_current, &arena)) {}
+    ~ArenaScope() { Arena::s_current = m_previous; }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+  private:
+    Arena* m_previous;
+};
+
+//! Resource for nodes, tables and symbol containers: the current arena, or the heap outside of any ArenaScope
+inline std::pmr::memory_resource* node_resource() noexcept {
+    if (auto arena = Arena::current()) return arena;
+    return std::pmr::new_delete_resource();
+}
+
+//! Base for heap objects created with plain new (procedure and module tables)
+//! that should live in the current arena. The owning resource is kept in a
+//! header so that delete works after the scope has ended.
+struct ArenaAllocated {
+    static void* operator new(size_t size) {
+        auto resource = node_resource();
+        auto block = static_cast<Header*>(resource->allocate(size + sizeof(Header), alignof(Header)));
+        block->resource = resource;
+        block->size = size;
+        return block + 1;
+    }
+
+    static void operator delete(void* ptr) noexcept {
+        if (!ptr) return;
+        auto block = static_cast<Header*>(ptr) - 1;
+        block->resource->deallocate(block, block->size + sizeof(Header), alignof(Header));
+    }
+
+  private:
+    struct alignas(std::max_align_t) Header {
+        std::pmr::memory_resource* resource;
+        size_t size;
+    };
+};
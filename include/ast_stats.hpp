@@ -0,0 +1,42 @@
+#pragma once
+
+#include "expression_nodes.hpp"
+#include "flat_ast.hpp"
+#include "statement_nodes.hpp"
+#include <array>
+#include <ostream>
+
+//! Number of AST nodes of the loaded modules, grouped by node kind, and multimethod call bindings (--stats)
+class AstStats {
+public:
+    static AstStats& instance() noexcept;
+
+    static bool enabled() noexcept { return s_enabled; }
+    static void enable() noexcept { s_enabled = true; }
+
+    //! Single linear pass over the flat records of a module
+    void count(const FlatAst& ast) {
+        for (auto& record : ast.records()) m_counts[size_t(record.kind)]++;
+    }
+
+    //! Multimethod call sites, counted once when the call is bound
+    void count_call(const nodes::MultimethodBinding& binding) {
+        if (binding.kind == nodes::MultimethodBinding::DYNAMIC) m_dynamic_calls++;
+        else if (binding.instance) m_static_calls++;
+        else m_base_calls++;
+    }
+
+    //! Lowering chosen for a CASE over integer or character labels
+    void count_case(const nodes::CaseDispatch& dispatch) { m_case_dispatch[dispatch.kind]++; }
+
+    void print(std::ostream& stream) const;
+
+private:
+    AstStats() {}
+    static inline bool s_enabled = false;
+    std::array<size_t, size_t(FlatAst::Kind::Count)> m_counts{};
+    size_t m_static_calls = 0;  //!< Bound to an instance at compile time
+    size_t m_base_calls = 0;    //!< Bound to the base procedure at compile time
+    size_t m_dynamic_calls = 0; //!< Dispatched at run time
+    std::array<size_t, 3> m_case_dispatch{}; //!< Indexed by CaseDispatch::Kind
+};
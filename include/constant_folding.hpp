@@ -0,0 +1,47 @@
+#pragma once
+
+#include "message_container.hpp"
+#include "semantic_context.hpp"
+#include "statement_nodes.hpp"
+
+/*!
+ * Folding pass over a statement sequence, run before it is checked.
+ * Constant subexpressions are replaced with Value nodes bottom-up, so every
+ * constant is looked up once and an operation is only evaluated when all of
+ * its operands are values. IF and WHILE branches with a FALSE condition or
+ * following a TRUE one, and CASE arms other than the one selected by a
+ * constant selector, are removed. The removed code is collected unfolded in
+ * pruned(), so that it is still checked once. Folded nodes are new nodes,
+ * the parsed tree is left as is.
+ */
+class ConstantFolder {
+public:
+    //! Report every removed branch as a note (--dump-folding)
+    static bool dump_enabled() noexcept { return s_dump; }
+    static void enable_dump() noexcept { s_dump = true; }
+
+    explicit ConstantFolder(nodes::Context& context) : m_context(context) {}
+
+    nodes::StatementSequence fold(const nodes::StatementSequence& seq);
+    nodes::ExpressionPtr fold(const nodes::ExpressionPtr& expr);
+
+    //! Statements holding the removed branches and arms, to be checked but never run
+    nodes::StatementSequence& pruned() { return m_pruned; }
+
+private:
+    void fold_statement(const nodes::StatementPtr& statement, nodes::StatementSequence& out);
+    void fold_if(const nodes::IfStatement& statement, nodes::StatementSequence& out);
+    void fold_while(const nodes::WhileStatement& statement, nodes::StatementSequence& out);
+    void fold_case(const nodes::CaseStatement& statement, nodes::StatementSequence& out);
+    std::optional<bool> fold_condition(nodes::ExpressionPtr& condition);
+    nodes::ExpressionPtr evaluate(const nodes::ExpressionPtr& expr, bool check_type);
+
+    template <class... Args>
+    void removed(CodePlace place, const char* str, const Args&... args) {
+        if (s_dump) m_context.messages.addFormat(MPriority::NOTE, place, str, args...);
+    }
+
+    static inline bool s_dump = false;
+    nodes::Context& m_context;
+    nodes::StatementSequence m_pruned;
+};
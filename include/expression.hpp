@@ -11,6 +11,8 @@ struct SymbolToken;
 namespace nodes {
 
 struct Expression : Node {
+    explicit Expression(NodeKind k) : Node(k) {}
+    static bool classof(NodeKind k) { return k >= NodeKind::IntegerValue && k <= NodeKind::Term; }
     virtual Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context&) const = 0;
     virtual Maybe<ValuePtr> eval_constant(Context&) const = 0;
     virtual ~Expression() = default;
@@ -48,6 +50,8 @@ inline constexpr OpType operator & (OpType left, OpType right) {
 constexpr OpType OP_COMPARE = OP_EQ | OP_NEQ | OP_LT | OP_LTE | OP_GT | OP_GTE;
 
 struct Value : Expression {
+    explicit Value(NodeKind k) : Expression(k) {}
+    static bool classof(NodeKind k) { return k >= NodeKind::IntegerValue && k <= NodeKind::BaseProcedureValue; }
     virtual Maybe<ValuePtr> apply_operator(Context&, OpType, const Value&) const = 0;
 };
 
@@ -79,9 +83,17 @@ struct Designator {
     Designator(QualIdent i, std::vector<Selector> s) : ident(i), selector(s) {}
     std::string to_string() const { return fmt::format("{}{}", ident, fmt::join(selector, "")); }
     bool is_simple() const { return selector.empty() && !ident.qual; }
+    //! Binds an unqualified name to its declaration visible from \p scope, false for qualified or unknown names
+    bool bind(const SymbolTable& scope) const;
+    //! Copy of the designated symbol; with selectors, its type is the type of the selected element
     Maybe<SymbolToken> get_symbol(Context&, CodePlace) const;
     QualIdent ident;
     std::vector<Selector> selector;
+private:
+    //! Unqualified name resolved once per scope by resolve_names, later uses read the symbol slot directly;
+    //! the scope is kept by SymbolTable::id, as a table address may be reused by a later table
+    mutable uint64_t m_bound_scope = 0;
+    mutable SymbolBinding m_binding{};
 };
 
 bool designator_repair(Designator& value, Context& table);
@@ -7,10 +7,12 @@
 #include <bitset>
 
 struct SymbolToken;
+class MultimethodInstanceTable;
 
 namespace nodes {
 
 struct IntegerValue : Value {
+    static constexpr NodeKind node_kind = NodeKind::IntegerValue;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context&) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
@@ -18,29 +20,32 @@ struct IntegerValue : Value {
 
     bool operator == (const IntegerValue& other) const { return value == other.value; }
 
-    IntegerValue(Integer i) : value(i) {}
+    IntegerValue(Integer i) : Value(node_kind), value(i) {}
     Integer value;
 };
 
 struct RealValue : Value {
+    static constexpr NodeKind node_kind = NodeKind::RealValue;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context&) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
     Maybe<ValuePtr> apply_operator(Context&, OpType, const Value&) const override;
-    RealValue(Real d) : value(d) {}
+    RealValue(Real d) : Value(node_kind), value(d) {}
     Real value;
 };
 
 struct CharValue : Value {
+    static constexpr NodeKind node_kind = NodeKind::CharValue;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
     Maybe<ValuePtr> apply_operator(Context&, OpType, const Value&) const override;
-    CharValue(char c) : value(c) {}
+    CharValue(char c) : Value(node_kind), value(c) {}
     char value;
 };
 
 struct StringValue : Value {
+    static constexpr NodeKind node_kind = NodeKind::StringValue;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
@@ -48,34 +53,37 @@ struct StringValue : Value {
 
     bool operator == (const StringValue& other) const  { return value == other.value; }
 
-    StringValue(std::vector<char> v) : value(v) {}
-    StringValue(char v) : value{v} {}
+    StringValue(std::vector<char> v) : Value(node_kind), value(v) {}
+    StringValue(char v) : Value(node_kind), value{v} {}
     std::vector<char> value;
 };
 
 struct NilValue : Value {
+    static constexpr NodeKind node_kind = NodeKind::NilValue;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
     Maybe<ValuePtr> apply_operator(Context&, OpType, const Value&) const override;
-    NilValue() {}
+    NilValue() : Value(node_kind) {}
 };
 
 struct BooleanValue : Value {
+    static constexpr NodeKind node_kind = NodeKind::BooleanValue;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
     Maybe<ValuePtr> apply_operator(Context&, OpType, const Value&) const override;
-    BooleanValue(bool v) : value(v) {}
+    BooleanValue(bool v) : Value(node_kind), value(v) {}
     bool value;
 };
 
 struct SetValue : Value {
+    static constexpr NodeKind node_kind = NodeKind::SetValue;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
     Maybe<ValuePtr> apply_operator(Context&, OpType, const Value&) const override;
-    SetValue(std::bitset<64> s) : values(s) {};
+    SetValue(std::bitset<64> s) : Value(node_kind), values(s) {};
 
     using SetType = std::bitset<64>;
     SetType values;
@@ -89,6 +97,7 @@ enum class BPType {
 };
 
 struct BaseProcedureValue : Value {
+    static constexpr NodeKind node_kind = NodeKind::BaseProcedureValue;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context&) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
@@ -106,6 +115,7 @@ struct SetElement {
 };
 
 struct Set : Expression {
+    static constexpr NodeKind node_kind = NodeKind::Set;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
@@ -123,33 +133,50 @@ bool proccall_repair(ProcCallData&, Context&);
 
 using ProcCallDataRepairer = Repairer<ProcCallData, Context, proccall_repair>;
 
+//! Target of a multimethod call, resolved when the call is type checked
+struct MultimethodBinding {
+    enum Kind { STATIC, DYNAMIC } kind;
+    //! Instance selected by the cases of the common arguments, nullptr for the base procedure or dynamic dispatch
+    const MultimethodInstanceTable* instance;
+};
+
 struct ProcCall : Expression {
+    static constexpr NodeKind node_kind = NodeKind::ProcCall;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
-    ProcCall(std::optional<std::vector<QualIdent>> c, DesignatorRepairer i, std::optional<ExpList> e) : data(c, i, e) {}
+    ProcCall(std::optional<std::vector<QualIdent>> c, DesignatorRepairer i, std::optional<ExpList> e) : Expression(node_kind), data(c, i, e) {}
     ProcCallDataRepairer data;
+    mutable std::optional<MultimethodBinding> multimethod;
 };
 
 struct Tilda : Expression {
+    static constexpr NodeKind node_kind = NodeKind::Tilda;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
-    Tilda(ExpressionPtr ptr) : expression(ptr) {}
+    Tilda(ExpressionPtr ptr) : Expression(node_kind), expression(ptr) {}
     ExpressionPtr expression;
 };
 
+//! Chain of operands of one precedence level, evaluated left to right: sign first op operand op operand ...
 struct Term : Expression {
+    struct Operation {
+        Operator oper;
+        ExpressionPtr operand;
+    };
+    static constexpr NodeKind node_kind = NodeKind::Term;
     std::string to_string() const override;
     Maybe<std::pair<SymbolGroup, TypePtr>> get_type(Context& table) const override;
     Maybe<ValuePtr> eval_constant(Context&) const override;
-    Term() {}
-    Term(std::optional<char> s, ExpressionPtr f, std::optional<std::tuple<Operator, ExpressionPtr>> sec);
-    Term(ExpressionPtr f, std::optional<std::tuple<Operator, ExpressionPtr>> sec);
+    Term() : Expression(node_kind) {}
+    Term(std::optional<char> s, ExpressionPtr f, std::vector<Operation> ops)
+        : Expression(node_kind), sign(s), first(f), operations(std::move(ops)) {}
+    //! A chain without operations and sign is only a wrapper around its operand
+    bool is_trivial() const { return !sign && operations.empty(); }
     std::optional<char> sign;
     ExpressionPtr first;
-    std::optional<Operator> oper;
-    std::optional<ExpressionPtr> second;
+    std::vector<Operation> operations;
 };
 
 } // namespace nodes
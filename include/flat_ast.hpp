@@ -0,0 +1,120 @@
+#pragma once
+
+#include "nodes.hpp"
+#include <cstdint>
+#include <span>
+
+/*!
+ * Flat encoding of a parsed module. Every node is a fixed-size record in one
+ * contiguous array, children are referenced through 32-bit indices stored in
+ * a second array, and payloads (identifiers, literals, operators) live in
+ * side tables. Records are appended in post-order, so children always precede
+ * their parent and the module record is the last one.
+ *
+ * The encoding is a tree: every record has exactly one parent. Deref
+ * selectors have no place of their own in the pointer tree and carry the
+ * place of their designator; both values of a label range carry the place
+ * of the label.
+ */
+class FlatAst {
+public:
+    using Index = std::uint32_t;
+
+    enum class Kind : std::uint8_t {
+        Module,
+        Definition,
+        ConstDecl,
+        TypeDecl,
+        VarDecl,
+        ProcedureDecl,
+        ProcedureDef,
+        Sequence,
+        // Statements
+        Assignment,
+        If,
+        Case,
+        CaseBranch,
+        CaseLabel,
+        While,
+        Repeat,
+        For,
+        Call,
+        // Expressions
+        Integer,
+        Real,
+        Char,
+        String,
+        Nil,
+        Boolean,
+        SetValue,
+        BuiltIn,
+        Set,
+        SetRange,
+        ProcCall,
+        Designator,
+        Field,
+        Index,
+        Deref,
+        Guard,
+        Tilda,
+        Term,
+        // Types
+        BuiltInType,
+        TypeName,
+        ImportTypeName,
+        RecordType,
+        PointerType,
+        ConstStringType,
+        ArrayType,
+        ProcedureType,
+        Parameter,
+        VarParameter,
+        CommonType,
+        ScalarType,
+        Count
+    };
+
+    struct Record {
+        Kind kind;
+        Index place;       //!< Offset of the node in the module source
+        Index first_child; //!< Start of the child range in children()
+        Index child_count;
+        Index payload;     //!< Index into the side table selected by kind, or an inline value
+    };
+
+    static constexpr Index no_payload = ~Index(0);
+
+    static FlatAst build(const nodes::IModule& module);
+
+    const std::vector<Record>& records() const { return m_records; }
+    const Record& operator[](Index node) const { return m_records[node]; }
+    Index root() const { return Index(m_records.size() - 1); }
+    std::span<const Index> children(Index node) const {
+        auto& record = m_records[node];
+        return {m_children.data() + record.first_child, record.child_count};
+    }
+    CodePlace place(Index node) const { return CodePlace(m_records[node].place); }
+
+    const nodes::Ident& ident(Index node) const { return m_idents[m_records[node].payload]; }
+    nodes::Integer integer(Index node) const { return m_integers[m_records[node].payload]; }
+    nodes::Real real(Index node) const { return m_reals[m_records[node].payload]; }
+    const std::vector<char>& string(Index node) const { return m_strings[m_records[node].payload]; }
+    //! Operator applied before each child of a Term; for the first child it is the sign, OP_SUB, OP_ADD or none
+    std::span<const nodes::OpType> operators(Index node) const {
+        auto& record = m_records[node];
+        return {m_operators.data() + record.payload, record.child_count};
+    }
+
+    static const char* kind_to_str(Kind kind);
+
+private:
+    class Builder;
+
+    std::vector<Record> m_records;
+    std::vector<Index> m_children;
+    std::vector<nodes::Ident> m_idents;
+    std::vector<nodes::Integer> m_integers;
+    std::vector<nodes::Real> m_reals;
+    std::vector<std::vector<char>> m_strings;
+    std::vector<nodes::OpType> m_operators;
+};
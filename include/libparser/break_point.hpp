@@ -1,4 +1,7 @@
+#pragma once
+
 #include "code_iterator.hpp"
+#include "profiler.hpp"
 
 /*!
  * \brief Точка возврата для парсера.
@@ -25,6 +28,8 @@ class BreakPoint {
         }
 
         if (state == OPEN) {
+            if (ParserProfiler::enabled())
+                ParserProfiler::instance().rollback(m_iter.place().get_index() - m_place.get_index());
             m_iter.move_to(m_place);
         }
     }
@@ -3,6 +3,7 @@
 #include "format.hpp"
 #include <fstream>
 #include <limits>
+#include <memory_resource>
 #include <optional>
 #include <stdexcept>
 #include <string_view>
@@ -37,7 +38,10 @@ struct fmt::formatter<CodePoint> {
 
 class CodeIterator {
 public:
-    CodeIterator(std::string_view data) : m_data(data), m_index(0), m_no_return_point(0) {}
+    CodeIterator(std::string_view data, std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
+        : m_data(data), m_index(0), m_no_return_point(0), m_resource(resource) {}
+    //! Ресурс памяти для узлов, создаваемых парсерами при разборе этого потока
+    std::pmr::memory_resource* resource() const noexcept { return m_resource; }
     CodePlace place() const noexcept { return CodePlace(m_index); }
     bool can_move_to(CodePlace place) noexcept { return place.get_index() >= m_no_return_point; }
     void move_to(CodePlace place) noexcept {
@@ -120,4 +124,5 @@ private:
     std::string_view m_data;
     size_t m_index;
     size_t m_no_return_point;
+    std::pmr::memory_resource* m_resource;
 };
@@ -44,7 +44,9 @@ public:
         return CodePoint{line, index};
     }
 
-    CodeIterator get_iterator() const { return CodeIterator(m_data); }
+    CodeIterator get_iterator(std::pmr::memory_resource* resource = std::pmr::new_delete_resource()) const {
+        return CodeIterator(m_data, resource);
+    }
 private:
     std::string m_data;
     std::vector<size_t> m_data_structure;
@@ -4,8 +4,13 @@
 #include "parser.hpp"
 #include "code_iterator.hpp"
 #include "selector.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory_resource>
 #include <optional>
 #include <variant>
+#include <vector>
 
 template <class T, size_t From>
 class CountFrom : public Parser<std::vector<T>> {
@@ -373,6 +378,12 @@ struct delim_index {
     }
 };
 
+/*!
+ * \brief Выбор первого успешного варианта с приведением результата к общему базовому типу.
+ *
+ * Узел результата размещается через ресурс памяти потока (CodeIterator::resource),
+ * что позволяет пользователю библиотеки подставить арену.
+ */
 template <class Base, class... Types>
 class BaseEither : public Parser<std::shared_ptr<Base>> {
   public:
@@ -389,7 +400,8 @@ class BaseEither : public Parser<std::shared_ptr<Base>> {
             auto res = parser->parse(stream);
             if (!res) return ParseResult<std::shared_ptr<Base>>{parse_error};
             point.close();
-            return ParseResult{std::static_pointer_cast<Base>(std::make_shared<T>(res.value()))};
+            return ParseResult{std::static_pointer_cast<Base>(
+                std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(stream.resource()), res.value()))};
         };
         ParseResult<std::shared_ptr<Base>> result;
         ((result = func(parsers)) || ...);
@@ -562,3 +574,88 @@ template <class T>
 inline auto debug(ParserPtr<T> parser, std::string message) {
     return make_parser(Debug(parser, message));
 }
+
+/*!
+ * \brief Разбор цепочек бинарных операций восхождением по приоритетам.
+ *
+ * Уровни перечисляются от низшего приоритета к высшему. На каждом уровне
+ * разбирается необязательный префикс, первый операнд следующего уровня и
+ * цепочка пар "операция операнд" длиной не более max_operations; операнды
+ * последнего уровня разбирает парсер операнда. Результат уровня строит
+ * функция build из собранной цепочки, поэтому выражение любой глубины
+ * разбирается одним узлом без промежуточных кортежей на каждом уровне.
+ */
+template <class Op, class Prefix>
+struct PrecedenceLevel {
+    PrecedenceLevel(ParserPtr<Op> oper, size_t max_operations = std::numeric_limits<size_t>::max())
+        : oper(oper), max_operations(max_operations) {}
+    PrecedenceLevel(ParserPtr<Op> oper, ParserPtr<Prefix> prefix)
+        : oper(oper), max_operations(std::numeric_limits<size_t>::max()), prefix(prefix) {}
+    ParserPtr<Op> oper;                      //!< Операция уровня
+    size_t max_operations;                   //!< Наибольшая длина цепочки
+    std::optional<ParserPtr<Prefix>> prefix; //!< Префикс перед первым операндом
+};
+
+template <class T, class Op, class Prefix>
+class PrecedenceClimbing : public Parser<T> {
+  public:
+    using Level = PrecedenceLevel<Op, Prefix>;
+    using Builder = std::function<T(size_t level, CodePlace place, std::optional<Prefix> prefix, T first,
+                                    std::vector<std::pair<Op, T>> operations)>;
+
+    PrecedenceClimbing(ParserPtr<T> operand, std::vector<Level> levels, Builder build)
+        : m_operand(operand), m_levels(std::move(levels)), m_build(std::move(build)) {}
+    ParseResult<T> parse(CodeIterator& stream) const noexcept override { return parse_level(stream, 0); }
+
+  private:
+    ParseResult<T> parse_operand(CodeIterator& stream, size_t level) const noexcept {
+        return level == m_levels.size() ? m_operand->parse(stream) : parse_level(stream, level);
+    }
+
+    ParseResult<T> parse_level(CodeIterator& stream, size_t level) const noexcept {
+        auto& rule = m_levels[level];
+        BreakPoint point(stream);
+        auto place = stream.place();
+        std::optional<Prefix> prefix;
+        if (rule.prefix) {
+            BreakPoint prefix_point(stream);
+            if (auto res = (*rule.prefix)->parse(stream); res) {
+                prefix_point.close();
+                prefix = std::move(res.value());
+            } else if (stream.has_undroppable_error()) {
+                return parse_error;
+            }
+        }
+        auto first = parse_operand(stream, level + 1);
+        if (!first) return parse_error;
+        std::vector<std::pair<Op, T>> operations;
+        while (operations.size() < rule.max_operations) {
+            BreakPoint step(stream);
+            auto oper = rule.oper->parse(stream);
+            if (!oper) {
+                if (stream.has_undroppable_error()) return parse_error;
+                break;
+            }
+            auto operand = parse_operand(stream, level + 1);
+            if (!operand) {
+                if (stream.has_undroppable_error()) return parse_error;
+                break;
+            }
+            step.close();
+            operations.emplace_back(std::move(oper.value()), std::move(operand.value()));
+        }
+        point.close();
+        return m_build(level, place, std::move(prefix), std::move(first.value()), std::move(operations));
+    }
+
+    ParserPtr<T> m_operand;
+    std::vector<Level> m_levels;
+    Builder m_build;
+};
+
+template <class T, class Op, class Prefix>
+inline ParserPtr<T> precedence_climbing(ParserPtr<T> operand,
+                                        std::vector<PrecedenceLevel<Op, Prefix>> levels,
+                                        typename PrecedenceClimbing<T, Op, Prefix>::Builder build) {
+    return make_parser(PrecedenceClimbing<T, Op, Prefix>(operand, std::move(levels), std::move(build)));
+}
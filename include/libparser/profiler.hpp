@@ -0,0 +1,117 @@
+#pragma once
+
+#include "parser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Профилировщик правил грамматики.
+ *
+ * Собирает для каждого именованного парсера (см. named) число попыток,
+ * успехов и неудач, количество поглощённых байт, количество байт
+ * возвращённых точками возврата (BreakPoint) и суммарное время.
+ * Пока профилировщик не включён, накладные расходы сводятся к одной проверке.
+ */
+class ParserProfiler {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct RuleStats {
+        std::string name;
+        size_t attempts = 0;
+        size_t successes = 0;
+        size_t failures = 0;
+        size_t consumed = 0;    //!< Байты, поглощённые успешными разборами
+        size_t rolled_back = 0; //!< Байты, возвращённые BreakPoint внутри правила
+        Clock::duration time{}; //!< Время без повторного учёта рекурсивных вызовов
+        size_t depth = 0;
+    };
+
+    static ParserProfiler& instance() {
+        static ParserProfiler profiler;
+        return profiler;
+    }
+
+    static bool enabled() noexcept { return s_enabled; }
+    static void enable() noexcept { s_enabled = true; }
+
+    size_t register_rule(std::string name) {
+        m_rules.push_back(RuleStats{std::move(name)});
+        return m_rules.size() - 1;
+    }
+
+    void enter(size_t rule) {
+        m_rules[rule].attempts++;
+        m_rules[rule].depth++;
+        m_stack.push_back(rule);
+    }
+
+    void leave(size_t rule, bool success, size_t consumed, Clock::duration time) {
+        auto& stats = m_rules[rule];
+        if (success) {
+            stats.successes++;
+            stats.consumed += consumed;
+        } else {
+            stats.failures++;
+        }
+        if (--stats.depth == 0) stats.time += time;
+        m_stack.pop_back();
+    }
+
+    //! Учёт отката, выполненного BreakPoint, в текущем правиле
+    void rollback(size_t bytes) {
+        if (!m_stack.empty()) m_rules[m_stack.back()].rolled_back += bytes;
+    }
+
+    void print(std::ostream& stream) const {
+        std::vector<const RuleStats*> rules;
+        for (auto& rule : m_rules) {
+            if (rule.attempts > 0) rules.push_back(&rule);
+        }
+        std::ranges::sort(rules, [](auto l, auto r) { return l->time > r->time; });
+        stream << fmt::format("{:<24} {:>10} {:>10} {:>10} {:>12} {:>12} {:>12}\n", "rule", "attempts", "success",
+                              "failure", "consumed", "rolled back", "time (ms)");
+        for (auto rule : rules) {
+            auto ms = std::chrono::duration_cast<std::chrono::nanoseconds>(rule->time).count() / 1e6;
+            stream << fmt::format("{:<24} {:>10} {:>10} {:>10} {:>12} {:>12} {:>12.3f}\n", rule->name, rule->attempts,
+                                  rule->successes, rule->failures, rule->consumed, rule->rolled_back, ms);
+        }
+    }
+
+  private:
+    ParserProfiler() {}
+    static inline bool s_enabled = false;
+    std::vector<RuleStats> m_rules;
+    std::vector<size_t> m_stack;
+};
+
+//! Именованное правило грамматики, учитываемое профилировщиком
+template <class T>
+class Named : public Parser<T> {
+  public:
+    Named(ParserPtr<T> parser, std::string name)
+        : m_parser(parser), m_rule(ParserProfiler::instance().register_rule(std::move(name))) {}
+    ParseResult<T> parse(CodeIterator& stream) const noexcept override {
+        if (!ParserProfiler::enabled()) return m_parser->parse(stream);
+        auto& profiler = ParserProfiler::instance();
+        auto start_place = stream.place().get_index();
+        auto start = ParserProfiler::Clock::now();
+        profiler.enter(m_rule);
+        auto res = m_parser->parse(stream);
+        profiler.leave(m_rule, res.has_value(), stream.place().get_index() - start_place,
+                       ParserProfiler::Clock::now() - start);
+        return res;
+    }
+
+  private:
+    ParserPtr<T> m_parser;
+    size_t m_rule;
+};
+
+template <class T>
+inline ParserPtr<T> named(ParserPtr<T> parser, std::string name) {
+    return make_parser(Named(parser, std::move(name)));
+}
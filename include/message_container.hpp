@@ -7,7 +7,7 @@
 class IOManager;
 
 enum MPriority : char {
-    ERR, W1, W2, W3, W4
+    ERR, W1, W2, W3, W4, NOTE
 };
 
 struct Message {
@@ -17,19 +17,43 @@ struct Message {
     std::string text;
 };
 
+/*!
+ * Formats and prints diagnostics. addFormat and addErr take the format
+ * arguments themselves (nodes by reference rather than their to_string()),
+ * and the text is only built once the message is known to be emitted: while
+ * a Mute is active messages are dropped without being formatted.
+ */
 class MessageContainer {
 public:
     MessageContainer(std::ostream& s, CodeStream& c) : m_stream(s), m_code(c) {}
     template <class... Args>
     void addFormat(MPriority priority, CodePlace place, const char* str, const Args&... args) noexcept {
+        if (muted()) return;
         addMessage({priority, place, fmt::format(str, args...)});
     }
     template <class... Args>
     void addErr(CodePlace place, const char* str, Args&&... args) noexcept {
+        if (muted()) return;
         addMessage({MPriority::ERR, place, fmt::format(str, std::forward<Args>(args)...)});
     }
     void addMessage(Message message);
+
+    bool muted() const { return m_muted > 0; }
+
+    //! Drops the messages of the container until the end of the scope
+    class Mute {
+    public:
+        explicit Mute(MessageContainer& messages) : m_messages(messages) { m_messages.m_muted++; }
+        ~Mute() { m_messages.m_muted--; }
+        Mute(const Mute&) = delete;
+        Mute& operator=(const Mute&) = delete;
+
+    private:
+        MessageContainer& m_messages;
+    };
+
 private:
     std::ostream& m_stream;
     CodeStream& m_code;
+    int m_muted = 0;
 };
@@ -1,11 +1,11 @@
 #pragma once
 
+#include "arena.hpp"
 #include "parser.hpp"
+#include "type_interner.hpp"
 #include "module_table_i.hpp"
 #include "io_manager.hpp"
 
-#include <chrono>
-
 std::string format_error(CodeStream& code, CodePlace place, std::string error);
 void print_error(CodeStream& code, CodePlace place, std::string error);
 
@@ -16,8 +16,16 @@ using ModuleResult = std::variant<ModuleLoader, std::string>;
 class ModuleLoader {
 public:
     ModuleLoader(ParserPtr<std::shared_ptr<nodes::IModule>> p) : parser(p) {}
+    //! The returned table and everything it refers to live in the loader's arenas and must not outlive it
     ModuleTableI* load(IOManager& io, std::string name);
+    //! Total allocations and allocated bytes of the module arenas
+    std::pair<size_t, size_t> arena_usage() const;
+    //! Lets record layouts reorder own fields to reduce padding
+    void set_field_reordering(bool reorder) { interner.set_field_reordering(reorder); }
 private:
     ParserPtr<std::shared_ptr<nodes::IModule>> parser;
+    // Arenas are declared before units so that they outlive every table and node referring into them
+    std::vector<std::unique_ptr<Arena>> arenas;
+    TypeInterner interner;
     std::unordered_map<nodes::Ident, std::unique_ptr<ModuleTableI>> units;
 };
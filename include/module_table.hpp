@@ -10,12 +10,15 @@ public:
     static std::unique_ptr<ModuleTable> parse(const nodes::Definition& def, std::vector<std::pair<nodes::Import, ModuleTablePtr>> imports, MessageContainer& mm);
 
     Maybe<SymbolToken> get_symbol_out(MessageContainer&, const nodes::QualIdent& ident, bool secretly = false) const override;
+    const SymbolEntry* find_export(const nodes::Ident& ident) const override;
+    void build_export_view() override;
     virtual Maybe<SymbolToken> get_symbol(MessageContainer&, const nodes::QualIdent& ident, bool secretly = false) const override;
     virtual Maybe<nodes::ValuePtr> get_value(MessageContainer&, const nodes::QualIdent& ident, bool secretly = false) const override;
     Maybe<TablePtr> get_table(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const override;
 
     const SymbolContainer& get_symbols() const override { return symbols; }
     SymbolContainer& get_symbols() override { return symbols; }
+    std::span<const SymbolContainer* const> display() const override { return {&m_scope, 1}; }
 
     virtual std::string to_string() const override;
     bool analyze_code(MessageContainer& messages) const override;
@@ -24,7 +27,10 @@ private:
     ModuleTable() {}
     bool add_import(MessageContainer&, nodes::Import import, ModuleTablePtr module);
     SymbolContainer symbols;
+    const SymbolContainer* m_scope = &symbols;
     nodes::Ident m_name;
-    SymbolMap<Import> m_imports;
-    SymbolSet m_exports;
+    SymbolMap<Import> m_imports{node_resource()};
+    SymbolSet m_exports{node_resource()};
+    //! Exported symbols with the group importers see and the values of constants, immutable once built
+    SymbolMap<SymbolEntry> m_export_view{node_resource()};
 };
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "symbol_container.hpp"
 #include "symbol_table.hpp"
 
 class ModuleTableI : public SemanticUnit {
 public:
     virtual Maybe<SymbolToken> get_symbol_out(MessageContainer&, const nodes::QualIdent& ident, bool secretly = false) const = 0;
+    //! Exported symbol as importers see it with the value of a constant, nullptr if the name is not exported
+    virtual const SymbolEntry* find_export(const nodes::Ident& ident) const = 0;
+    //! Freezes the exports of an analyzed module; afterwards find_export does not modify the table
+    virtual void build_export_view() = 0;
 };
 
 using ModuleTablePtr = ModuleTableI const*;
@@ -5,9 +5,33 @@
 #include "procedure_table.hpp"
 #include "symbol_container.hpp"
 #include "symbol_table.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
 
 class MultimethodInstanceTable;
 
+/*!
+ * Dispatch index of a multimethod. Every common parameter is an axis whose
+ * extent is the number of cases of its common type; the table holds, in
+ * row-major order over the case indices, the number of the instance for
+ * each combination of cases or no_instance where the base procedure runs.
+ * The table is complete once the module is analyzed and can be indexed by
+ * a runtime as is.
+ */
+struct MultimethodDispatch {
+    static constexpr std::int32_t no_instance = -1;
+
+    size_t offset(std::span<const size_t> cases) const {
+        size_t result = 0;
+        for (size_t i = 0; i < extents.size(); i++) result = result * extents[i] + cases[i];
+        return result;
+    }
+
+    std::vector<std::uint32_t> extents;
+    std::vector<std::int32_t> table;
+};
+
 class MultimethodTable : public ProcedureTable {
 public:
     static std::unique_ptr<MultimethodTable> parse(const nodes::ProcedureDeclaration& proc, const SymbolTable* parent, MessageContainer& mm);
@@ -22,12 +46,29 @@ public:
     bool analyze_code(MessageContainer& messages) const override;
 
     bool instance_compatible(MessageContainer& messages, bool with_messages, const ProcedureTable& instance) const;
+
+    //! Index of a case of the common type of a common parameter
+    std::optional<size_t> case_index(size_t param, const nodes::CommonFeature& feature) const;
+    //! Instance selected by the case indices of all common parameters, nullptr for the base procedure
+    const MultimethodInstanceTable* instance_for(std::span<const size_t> cases) const;
+    const MultimethodDispatch& dispatch() const { return m_dispatch; }
+
+    //! Report the dispatch table of every multimethod as a note (--dump-dispatch)
+    static bool dump_enabled() noexcept { return s_dump_dispatch; }
+    static void enable_dump() noexcept { s_dump_dispatch = true; }
 private:
     MultimethodTable() {}
+    void report_missing_instances(MessageContainer& messages) const;
+    void dump_dispatch(MessageContainer& messages) const;
+
+    static inline bool s_dump_dispatch = false;
+
     nodes::Ident m_name;
     nodes::ProcedureType m_type;
     SymbolContainer m_symbols;
     std::vector<std::shared_ptr<MultimethodInstanceTable>> m_instances;
+    std::vector<const nodes::CommonType*> m_axes;
+    MultimethodDispatch m_dispatch;
     const SymbolTable* m_parent;
 };
 
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "statement.hpp"
+
+class SymbolTable;
+
+/*!
+ * Name resolution pass, run once per table before its code is checked. Every
+ * unqualified designator in \p body is bound to the (depth, slot) of its
+ * declaration visible from \p scope, so type checking reads symbols straight
+ * from their slots. Qualified names are left to the repair step, which may
+ * turn them into field selections of a variable; designators it creates are
+ * bound on first use.
+ */
+void resolve_names(const SymbolTable& scope, const nodes::StatementSequence& body);
@@ -11,25 +11,94 @@ namespace nodes {
 
 using Context = SemanticContext;
 
+//! Concrete node classes, ordered so that every abstract base covers a contiguous range
+enum class NodeKind : std::uint8_t {
+    Ident,
+    // Expressions
+    IntegerValue,
+    RealValue,
+    CharValue,
+    StringValue,
+    NilValue,
+    BooleanValue,
+    SetValue,
+    BaseProcedureValue,
+    Set,
+    ProcCall,
+    Tilda,
+    Term,
+    // Statements
+    Assignment,
+    IfStatement,
+    CaseStatement,
+    WhileStatement,
+    RepeatStatement,
+    ForStatement,
+    CallStatement,
+    // Types
+    BuiltInType,
+    TypeName,
+    ImportTypeName,
+    RecordType,
+    PointerType,
+    ConstStringType,
+    ArrayType,
+    ProcedureType,
+    CommonType,
+    ScalarType,
+    // Sections
+    ProcedureDeclaration,
+    ProcedureDefinition,
+    Module,
+    Definition,
+};
+
+struct Node;
+
+template <class T>
+bool isa(const Node& node);
+
 struct Node {
+    explicit Node(NodeKind k) : kind(k) {}
     CodePlace place;
+    NodeKind kind;
     template <class T>
     const T* is() const {
-        return dynamic_cast<const T*>(this);
+        return isa<T>(*this) ? static_cast<const T*>(this) : nullptr;
     }
     template <class T>
     T* is() {
-        return dynamic_cast<T*>(this);
+        return isa<T>(*this) ? static_cast<T*>(this) : nullptr;
     }
     virtual std::string to_string() const = 0;
     virtual ~Node() {}
 };
 
+//! Concrete classes declare node_kind, abstract bases provide classof over a range of kinds
+template <class T>
+bool isa(const Node& node) {
+    if constexpr (requires { T::node_kind; })
+        return node.kind == T::node_kind;
+    else
+        return T::classof(node.kind);
+}
+
+template <class T>
+const T* dyn_cast(const Node* node) {
+    return node && isa<T>(*node) ? static_cast<const T*>(node) : nullptr;
+}
+
+template <class T>
+T* dyn_cast(Node* node) {
+    return node && isa<T>(*node) ? static_cast<T*>(node) : nullptr;
+}
+
 // using Ident = std::vector<char>;
 
 struct Ident : public Node {
-    Ident() {}
-    Ident(std::vector<char> v) : value(v) {}
+    static constexpr NodeKind node_kind = NodeKind::Ident;
+    Ident() : Node(node_kind) {}
+    Ident(std::vector<char> v) : Node(node_kind), value(v) {}
     std::string to_string() const override { return fmt::format("{}", fmt::join(value, "")); };
     bool equal_to(const char* str) const {
         size_t i = 0;
@@ -17,6 +17,19 @@ struct fmt::formatter<nodes::Ident> {
     }
 };
 
+//! Nodes passed by reference to diagnostics, printed only when the message is formatted
+template <class T>
+struct fmt::formatter<T, char, std::enable_if_t<std::is_base_of_v<nodes::Node, T> && !std::is_same_v<T, nodes::Ident>>> {
+    template <typename ParseContext>
+    constexpr auto parse(ParseContext& ctx) {
+        return ctx.begin();
+    }
+    template <typename FormatContext>
+    auto format(const nodes::Node& node, FormatContext& ctx) {
+        return fmt::format_to(ctx.out(), "{}", node.to_string());
+    }
+};
+
 template <>
 struct fmt::formatter<nodes::TypePtr> {
     template <typename ParseContext>
@@ -250,8 +263,8 @@ struct fmt::formatter<nodes::CaseLabel> {
     auto format(nodes::CaseLabel const& id, FormatContext& ctx) {
         std::string str;
         if (id.second)
-            str = std::visit([](auto&& arg) { return fmt::format("{}", arg); }, *id.second);
-        return std::visit([&str,&ctx](auto&& arg) { return fmt::format_to(ctx.out(), "{}..{}", arg, str); }, id.first);
+            str = std::visit([](auto&& arg) { return fmt::format("..{}", arg); }, *id.second);
+        return std::visit([&str,&ctx](auto&& arg) { return fmt::format_to(ctx.out(), "{}{}", arg, str); }, id.first);
     }
 };
 
@@ -1,20 +1,31 @@
 #pragma once
 
+#include "arena.hpp"
 #include <vector>
 #include <string_view>
 #include <memory>
+#include <memory_resource>
 
 namespace nodes {
 
 using Real = double;
 using Integer = int;
 
+/*!
+ * Owning reference to a node or type. The module arena only changes where
+ * nodes are allocated: the object and its control block share one arena
+ * chunk and are released with the arena, but ownership and its atomic
+ * reference counts are still those of shared_ptr. Replacing OPtr with a
+ * non-owning arena handle is not done, as it changes every node, type and
+ * table of the analyser.
+ */
 template <class T>
 using OPtr = std::shared_ptr<T>;
 
+//! Allocates from node_resource(), which is the module arena during loading
 template <class Out, class T, class... Args>
 OPtr<Out> make_optr(Args&&... val) {
-    return std::static_pointer_cast<Out>(std::make_shared<T>(val...));
+    return std::static_pointer_cast<Out>(std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(node_resource()), val...));
 }
 
 }
@@ -12,18 +12,21 @@ public:
     virtual bool overload(MessageContainer&, std::shared_ptr<ProcedureTable>) = 0;
     virtual const SymbolTable& parent() const = 0;
 
-    virtual Maybe<SymbolToken> get_symbol(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const override {
-        if (ident.qual) {
-            return parent().get_symbol(messages, ident, secretly);
-        } else {
-            if (!get_symbols().has_symbol(ident)) {
-                return parent().get_symbol(messages, ident, secretly);
-            } else {
-                auto res = get_symbols().get_symbol(messages, ident, secretly);
-                if (!res) return error;
-                return res;
-            }
+    //! Built on first use, when the parent chain is complete
+    std::span<const SymbolContainer* const> display() const override {
+        if (m_display.empty()) {
+            auto outer = parent().display();
+            m_display.assign(outer.begin(), outer.end());
+            m_display.push_back(&get_symbols());
         }
+        return m_display;
+    }
+
+    virtual Maybe<SymbolToken> get_symbol(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const override {
+        if (!ident.qual)
+            if (auto binding = bind(ident.ident); binding)
+                return bound_symbol(*binding, secretly);
+        return parent().get_symbol(messages, ident, secretly);
     }
 
     virtual Maybe<nodes::ValuePtr> get_value(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const override {
@@ -62,6 +65,9 @@ public:
         auto context = nodes::Context(messages, *this);
         return get_symbols().analyze_code(context);
     }
+
+private:
+    mutable std::pmr::vector<const SymbolContainer*> m_display{node_resource()};
 };
 
 std::unique_ptr<ProcedureTable> build_procedure_table(const nodes::ProcedureDeclaration& proc,
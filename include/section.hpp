@@ -5,6 +5,8 @@
 namespace nodes {
 
 struct Section : Node {
+    explicit Section(NodeKind k) : Node(k) {}
+    static bool classof(NodeKind k) { return k >= NodeKind::ProcedureDeclaration && k <= NodeKind::Definition; }
     virtual ~Section() = default;
 };
 
@@ -40,10 +40,11 @@ struct ProcedureDeclarationBody {
 };
 
 struct ProcedureDeclaration : Section {
+    static constexpr NodeKind node_kind = NodeKind::ProcedureDeclaration;
     std::string to_string() const override;
-    ProcedureDeclaration() {}
+    ProcedureDeclaration() : Section(node_kind) {}
     ProcedureDeclaration(IdentDef n, ProcedureType t, std::variant<std::string_view, ProcedureDeclarationBody> var)
-        : name(n), type(t) {
+        : Section(node_kind), name(n), type(t) {
         if (var.index() == 1) {
             body = std::get<1>(var);
         }
@@ -63,15 +64,18 @@ struct Import {
 using ImportList = std::vector<Import>;
 
 struct IModule : Section {
+    explicit IModule(NodeKind k) : Section(k) {}
+    static bool classof(NodeKind k) { return k == NodeKind::Module || k == NodeKind::Definition; }
     virtual Ident get_name() const = 0;
     virtual ImportList get_imports() const = 0;
 };
 
 struct Module : IModule {
+    static constexpr NodeKind node_kind = NodeKind::Module;
     std::string to_string() const override;
-    Module() {}
+    Module() : IModule(node_kind) {}
     Module(Ident n, ImportList i, DeclarationSequence d, StatementSequence b)
-        : name(n), imports(i), declarations(d), body(b) {}
+        : IModule(node_kind), name(n), imports(i), declarations(d), body(b) {}
     Ident get_name() const override { return name; };
     ImportList get_imports() const override { return imports; }
     Ident name;
@@ -81,10 +85,11 @@ struct Module : IModule {
 };
 
 struct ProcedureDefinition : Section {
+    static constexpr NodeKind node_kind = NodeKind::ProcedureDefinition;
     std::string to_string() const override;
-    ProcedureDefinition() {}
+    ProcedureDefinition() : Section(node_kind) {}
     ProcedureDefinition(IdentDef n, ProcedureType t)
-        : name(n), type(t) {}
+        : Section(node_kind), name(n), type(t) {}
     IdentDef name;
     ProcedureType type;
 };
@@ -97,10 +102,11 @@ struct DefinitionSequence {
 };
 
 struct Definition : IModule {
+    static constexpr NodeKind node_kind = NodeKind::Definition;
     std::string to_string() const override;
-    Definition() {}
+    Definition() : IModule(node_kind) {}
     Definition(Ident n, ImportList i, DefinitionSequence d)
-        : name(n), imports(i), definitions(d) {}
+        : IModule(node_kind), name(n), imports(i), definitions(d) {}
     Ident get_name() const override { return name; };
     ImportList get_imports() const override { return imports; }
     Ident name;
@@ -5,6 +5,8 @@
 namespace nodes {
 
 struct Statement : Node {
+    explicit Statement(NodeKind k) : Node(k) {}
+    static bool classof(NodeKind k) { return k >= NodeKind::Assignment && k <= NodeKind::CallStatement; }
     virtual bool check(Context&) const = 0;
     virtual ~Statement(){};
 };
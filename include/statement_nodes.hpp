@@ -4,13 +4,15 @@
 #include "statement.hpp"
 #include "const_value.hpp"
 #include <optional>
+#include <vector>
 
 namespace nodes {
 
 struct Assignment : Statement {
+    static constexpr NodeKind node_kind = NodeKind::Assignment;
     std::string to_string() const override;
     virtual bool check(Context&) const override;
-    Assignment(DesignatorRepairer var, ExpressionPtr val) : variable(var), value(val) {}
+    Assignment(DesignatorRepairer var, ExpressionPtr val) : Statement(node_kind), variable(var), value(val) {}
     DesignatorRepairer variable;
     ExpressionPtr value;
 };
@@ -18,9 +20,10 @@ struct Assignment : Statement {
 using IfBlock = std::tuple<ExpressionPtr, StatementSequence>;
 
 struct IfStatement : Statement {
+    static constexpr NodeKind node_kind = NodeKind::IfStatement;
     std::string to_string() const override;
     bool check(Context&) const override;
-    IfStatement(std::vector<IfBlock> ib, std::optional<StatementSequence> eb) : if_blocks(ib), else_block(eb) {}
+    IfStatement(std::vector<IfBlock> ib, std::optional<StatementSequence> eb) : Statement(node_kind), if_blocks(ib), else_block(eb) {}
     std::vector<IfBlock> if_blocks;
     std::optional<StatementSequence> else_block;
 };
@@ -28,41 +31,76 @@ struct IfStatement : Statement {
 using Label = std::variant<Integer, StringValue, QualIdent>;
 
 struct CaseLabel {
+    CaseLabel() {}
+    CaseLabel(Label f, std::optional<Label> s) : first(f), second(s) {}
     Label first;
     std::optional<Label> second;
+    CodePlace place{};
 };
 
 using CaseLabelList = std::vector<CaseLabel>;
 
+//! Value of an integer or character label
+inline Integer label_value(const Label& label) {
+    if (auto value = std::get_if<Integer>(&label); value) return *value;
+    return static_cast<unsigned char>(std::get<StringValue>(label).value.front());
+}
+
 using Case = std::tuple<CaseLabelList, StatementSequence>;
 
+//! Label values from low to high selecting the case with index branch
+struct CaseInterval {
+    Integer low;
+    Integer high;
+    size_t branch;
+    CodePlace place; //!< Place of the label
+};
+
+//! Lowering of a CASE over integer or character labels, chosen by label density
+struct CaseDispatch {
+    enum Kind {
+        JUMP_TABLE,    //!< Table of branches indexed by value - low
+        BINARY_SEARCH, //!< Search over the sorted intervals
+        BIT_TEST       //!< One mask per branch over at most 64 values starting at low
+    } kind;
+    Integer low;
+    Integer high;
+    std::vector<CaseInterval> intervals; //!< Sorted and disjoint
+};
+
 struct CaseStatement : Statement {
+    static constexpr NodeKind node_kind = NodeKind::CaseStatement;
     std::string to_string() const override;
     bool check(Context&) const override;
-    CaseStatement(ExpressionPtr e, std::vector<Case> c) : expression(e), cases(c) {}
+    CaseStatement(ExpressionPtr e, std::vector<Case> c) : Statement(node_kind), expression(e), cases(c) {}
     ExpressionPtr expression;
     std::vector<Case> cases;
+    //! Set by check when all labels are integers or characters without overlaps
+    mutable std::optional<CaseDispatch> dispatch;
 };
 
 struct WhileStatement : Statement {
+    static constexpr NodeKind node_kind = NodeKind::WhileStatement;
     std::string to_string() const override;
     bool check(Context&) const override;
-    WhileStatement(std::vector<IfBlock> ib) : if_blocks(ib) {}
+    WhileStatement(std::vector<IfBlock> ib) : Statement(node_kind), if_blocks(ib) {}
     std::vector<IfBlock> if_blocks;
 };
 
 struct RepeatStatement : Statement {
+    static constexpr NodeKind node_kind = NodeKind::RepeatStatement;
     std::string to_string() const override;
     bool check(Context&) const override;
-    RepeatStatement(StatementSequence s, ExpressionPtr e) : if_block({e, s}) {}
+    RepeatStatement(StatementSequence s, ExpressionPtr e) : Statement(node_kind), if_block({e, s}) {}
     IfBlock if_block;
 };
 
 struct ForStatement : Statement {
+    static constexpr NodeKind node_kind = NodeKind::ForStatement;
     std::string to_string() const override;
     bool check(Context&) const override;
     ForStatement(Ident i, ExpressionPtr f, ExpressionPtr to, std::optional<ExpressionPtr> by, StatementSequence b)
-        : ident(i), for_expr(f), to_expr(to), by_expr(by ? by : std::nullopt), block(b) {}
+        : Statement(node_kind), ident(i), for_expr(f), to_expr(to), by_expr(by ? by : std::nullopt), block(b) {}
     Ident ident;
     ExpressionPtr for_expr;
     ExpressionPtr to_expr;
@@ -71,9 +109,10 @@ struct ForStatement : Statement {
 };
 
 struct CallStatement : Statement {
+    static constexpr NodeKind node_kind = NodeKind::CallStatement;
     std::string to_string() const override;
     bool check(Context&) const override;
-    CallStatement(ExpressionPtr c) : call(c) {}
+    CallStatement(ExpressionPtr c) : Statement(node_kind), call(c) {}
     ExpressionPtr call;
 };
 
@@ -3,6 +3,7 @@
 #include "symbol_table.hpp"
 #include "nodes.hpp"
 #include <functional>
+#include <vector>
 
 class ProcedureTable;
 
@@ -10,9 +11,24 @@ class MessageContainer;
 
 using ParseReturnType = std::optional<std::unique_ptr<SemanticUnit>>;
 
+//! Declared name with its constant value (for CONST declarations) and procedure table (for procedures)
+struct SymbolEntry {
+    SymbolToken symbol;
+    nodes::ValuePtr value;
+    TablePtr table;
+};
+
+/*!
+ * Symbols of one scope. Entries are stored in declaration order, and the slot
+ * of a symbol is its position in that order. Names are found through an
+ * open-addressing index with linear probing over the entry positions, so a
+ * lookup hashes the name once and yields the symbol, value and table together.
+ */
 class SymbolContainer {
 public:
     SymbolContainer() {}
+    SymbolContainer(const SymbolContainer&) = delete;
+    SymbolContainer& operator=(const SymbolContainer&) = delete;
     static bool parse(SymbolContainer& table, nodes::Context& context, const nodes::DeclarationSequence& seq, nodes::StatementSequence body, std::function<bool(nodes::IdentDef,nodes::Context&)> func);
 
     //SymbolTableI
@@ -26,12 +42,37 @@ public:
     //CodeSectionI
     bool analyze_code(nodes::Context& messages) const;
 
-    bool has_symbol(const nodes::QualIdent& ident) const { return symbols.contains(ident.ident); }
+    bool has_symbol(const nodes::QualIdent& ident) const { return !ident.qual && slot_of(ident.ident); }
+
+    //! Entry of an unqualified name declared in this scope, nullptr if there is none; does not count as a use
+    const SymbolEntry* find(const nodes::Ident& ident) const {
+        auto slot = slot_of(ident);
+        return slot ? &m_entries[*slot] : nullptr;
+    }
+
+    //! Slot of a symbol in declaration order, stable for the lifetime of the container
+    std::optional<uint32_t> slot_of(const nodes::Ident& ident) const;
+    const SymbolToken& symbol_at(uint32_t slot) const { return m_entries[slot].symbol; }
+    const SymbolToken& use_symbol(uint32_t slot) const {
+        auto& symbol = const_cast<SymbolToken&>(m_entries[slot].symbol);
+        symbol.count++;
+        return symbol;
+    }
 
     std::string to_string() const;
 private:
-    SymbolMap<SymbolToken> symbols;
-    SymbolMap<nodes::ValuePtr> values;
-    SymbolMap<TablePtr> tables;
+    static constexpr uint32_t empty_bucket = ~uint32_t(0);
+
+    SymbolEntry* find_mut(const nodes::Ident& ident) { return const_cast<SymbolEntry*>(find(ident)); }
+    void grow_index();
+
+    std::pmr::vector<SymbolEntry> m_entries{node_resource()};
+    //! Slots of m_entries by name hash; the size is a power of two and at most half of it is used
+    std::pmr::vector<uint32_t> m_index{node_resource()};
+    size_t m_values = 0;
+    size_t m_tables = 0;
+    //! Folded at the end of parse, once every name of the scope is declared
     nodes::StatementSequence body;
+    //! Code removed from body by folding, checked once so that its errors are still reported
+    nodes::StatementSequence pruned;
 };
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "arena.hpp"
 #include "node.hpp"
 #include "symbol_token.hpp"
+#include <atomic>
+#include <span>
 
 namespace std {
 
@@ -33,6 +36,9 @@ class SymbolContainer;
 
 class SymbolTable {
 public:
+    SymbolTable() noexcept : m_id(next_id()) {}
+    SymbolTable(const SymbolTable&) noexcept : m_id(next_id()) {}
+    SymbolTable& operator=(const SymbolTable&) noexcept { return *this; }
     virtual ~SymbolTable() {}
 
     virtual Maybe<SymbolToken> get_symbol(MessageContainer&, const nodes::QualIdent& ident, bool secretly = false) const = 0;
@@ -42,7 +48,25 @@ public:
     virtual const SymbolContainer& get_symbols() const = 0;
     virtual SymbolContainer& get_symbols() = 0;
 
+    //! Symbol containers of the enclosing scopes indexed by depth, from the module down to this table
+    virtual std::span<const SymbolContainer* const> display() const = 0;
+    //! Innermost declaration of an unqualified name visible from this scope, one lookup per level
+    std::optional<SymbolBinding> bind(const nodes::Ident& ident) const;
+    //! Symbol of a binding made in this scope; unless secretly, counts as a use like get_symbol
+    const SymbolToken& bound_symbol(SymbolBinding binding, bool secretly = false) const;
+
     virtual std::string to_string() const = 0;
+
+    //! Distinct for every table of the process, never 0; a copy gets its own id
+    uint64_t id() const noexcept { return m_id; }
+
+private:
+    static uint64_t next_id() noexcept {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t m_id;
 };
 
 class CodeSection {
@@ -51,4 +75,4 @@ public:
     virtual ~CodeSection() {}
 };
 
-struct SemanticUnit : public SymbolTable, public CodeSection {};
+struct SemanticUnit : public SymbolTable, public CodeSection, public ArenaAllocated {};
@@ -31,6 +31,12 @@ struct SymbolToken {
 
 using SymbolResult = Maybe<SymbolToken>;
 
+//! Resolved unqualified name: depth of the declaring scope (the module is 0) and slot of the symbol in it
+struct SymbolBinding {
+    uint32_t depth;
+    uint32_t slot;
+};
+
 template <>
 struct fmt::formatter<SymbolToken> {
     template <typename ParseContext>
@@ -44,7 +50,8 @@ struct fmt::formatter<SymbolToken> {
     }
 };
 
+//! Symbol maps are constructed with node_resource(), i.e. the arena of the module being loaded
 template <class T>
-using SymbolMap = std::unordered_map<nodes::Ident, T>;
+using SymbolMap = std::pmr::unordered_map<nodes::Ident, T>;
 
-using SymbolSet = std::unordered_set<nodes::Ident>;
+using SymbolSet = std::pmr::unordered_set<nodes::Ident>;
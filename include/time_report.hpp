@@ -0,0 +1,98 @@
+#pragma once
+
+#include "alloc_stats.hpp"
+#include "libparser/format.hpp"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! Aggregated tree of compiler phase timings (-ftime-report) with optional Chrome trace output.
+//! When the counting allocator is built in, each phase also records allocations and peak live bytes (--stats).
+class TimeReport {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static TimeReport& instance() noexcept;
+
+    bool enabled() const noexcept { return m_enabled; }
+    void enable(bool trace) noexcept;
+
+    size_t enter(std::string name);
+    void leave(size_t node, Clock::time_point start, Clock::time_point end);
+    //! Charges allocations made since \p before to the node and restores the enclosing peak
+    void leave_memory(size_t node, const AllocCounters& before, size_t outer_peak) noexcept;
+
+    void print(std::ostream& stream) const;
+    void print_memory(std::ostream& stream) const;
+    bool write_trace(const std::string& path) const;
+
+private:
+    TimeReport();
+
+    struct Node {
+        std::string name;
+        size_t parent;
+        std::vector<size_t> children;
+        size_t count = 0;
+        Clock::duration total{};
+        size_t allocations = 0;
+        size_t bytes = 0;
+        size_t peak = 0;
+    };
+
+    struct TraceEvent {
+        size_t node;
+        std::int64_t start;
+        std::int64_t duration;
+    };
+
+    void print_node(std::ostream& stream, size_t node, size_t depth, Clock::duration root_total) const;
+    void print_memory_node(std::ostream& stream, size_t node, size_t depth) const;
+
+    bool m_enabled = false;
+    bool m_trace = false;
+    std::vector<Node> m_nodes;
+    std::vector<TraceEvent> m_events;
+    size_t m_current = 0;
+    Clock::time_point m_origin;
+};
+
+//! RAII timer for one phase; nests under the innermost active PhaseTimer
+class PhaseTimer {
+public:
+    PhaseTimer(std::string_view name) {
+        if (TimeReport::instance().enabled()) start(std::string(name));
+    }
+    template <class... Args>
+    PhaseTimer(const char* format, const Args&... args) {
+        if (TimeReport::instance().enabled()) start(fmt::format(format, args...));
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+    ~PhaseTimer() {
+        if (!m_active) return;
+        auto& report = TimeReport::instance();
+        report.leave(m_node, m_start, TimeReport::Clock::now());
+        if (alloc_stats::enabled()) report.leave_memory(m_node, m_memory, m_outer_peak);
+    }
+
+private:
+    void start(std::string name) {
+        m_node = TimeReport::instance().enter(std::move(name));
+        m_active = true;
+        if (alloc_stats::enabled()) {
+            m_memory = alloc_stats::counters();
+            m_outer_peak = alloc_stats::restart_peak();
+        }
+        m_start = TimeReport::Clock::now();
+    }
+
+    bool m_active = false;
+    size_t m_node = 0;
+    TimeReport::Clock::time_point m_start;
+    AllocCounters m_memory;
+    size_t m_outer_peak = 0;
+};
@@ -4,12 +4,21 @@
 
 namespace nodes {
 
-struct Type : Node {
-    virtual Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const = 0;
-    virtual bool same(Context& context, const Type& other) const = 0;
-    virtual bool equal(Context& context, const Type& other) const = 0;
+//! Types made with make_type can hand out an owning reference to themselves, see TypeInterner::remember_normalized
+struct Type : Node, std::enable_shared_from_this<Type> {
+    explicit Type(NodeKind k) : Node(k) {}
+    static bool classof(NodeKind k) { return k >= NodeKind::BuiltInType && k <= NodeKind::ScalarType; }
+    //! Memoized per scope in TypeInterner for types owned by a TypePtr: repeated calls with the same symbol table return the stored result
+    Maybe<TypePtr> normalize(Context& context, bool normalize_pointers) const;
+    //! Same types: equal TypeInterner identities, i.e. the same declaration or the same built-in type
+    bool same(Context& context, const Type& other) const;
+    //! Equal types: same types, open arrays of equal elements or procedure types with matching parameters
+    virtual bool equal(Context& context, const Type& other) const;
     virtual bool assignment_compatible(Context& context, const Type& expr) const = 0;
     virtual ~Type() = default;
+
+protected:
+    virtual Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const = 0;
 };
 
 enum class BaseType {
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "symbol_table.hpp"
+#include "type_layout.hpp"
+#include "type_nodes.hpp"
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*!
+ * Canonical type identities for all modules of one ModuleLoader.
+ *
+ * identity() resolves type names and maps built-in, string and import types
+ * to one id per value; every other type is unique per declaration, as Oberon
+ * type equivalence is by name. canonical() additionally hash-conses open
+ * arrays and procedure signatures, whose equality is structural. Type::same
+ * and Type::equal compare these ids, and resolved names are cached per scope.
+ * The interner also keeps the result of Type::normalize per scope; the table
+ * lives outside of the nodes, so a type referring back to itself through its
+ * normalized form does not create an ownership cycle. Each entry also owns the
+ * node it was computed for, so no other node can take over its address and
+ * find a stale result while the entry exists.
+ *
+ * Record extension is encoded as a display: the identities of a record and
+ * of all its bases ordered from the root, so the extension level is the
+ * display size minus one and "A extends B" is one comparison at B's level.
+ * Displays are built when record types are declared and are shared by all
+ * modules; they are also the layout a backend needs for runtime type tests.
+ *
+ * Field tables of records, with inherited fields, and the size, alignment
+ * and field offsets of types are kept here too (see type_layout.cpp).
+ *
+ * Ids are addresses of arena objects or of interner entries, so the interner
+ * must not outlive the arenas of its loader; ModuleLoader owns both.
+ */
+class TypeInterner {
+public:
+    using TypeId = const void*;
+
+    //! Interner installed by the innermost ModuleLoader::load, nullptr outside of module loading
+    static TypeInterner* active() noexcept { return s_current; }
+
+    class Scope {
+    public:
+        explicit Scope(TypeInterner& interner) : m_previous(std::exchange(s_current, &interner)) {}
+        ~Scope() { s_current = m_previous; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TypeInterner* m_previous;
+    };
+
+    //! Id of the same-type equivalence class, nullptr if a type name can't be resolved
+    TypeId identity(nodes::Context& context, const nodes::Type& type);
+    //! Id of the equal-type equivalence class, nullptr if a type name can't be resolved
+    TypeId canonical(nodes::Context& context, const nodes::Type& type);
+
+    bool same(nodes::Context& context, const nodes::Type& left, const nodes::Type& right);
+    bool equal(nodes::Context& context, const nodes::Type& left, const nodes::Type& right);
+
+    //! Stored normalized form of a type in the current scope, nullptr if not normalized yet
+    nodes::TypePtr normalized(nodes::Context& context, const nodes::Type& type, bool normalize_pointers) const;
+    //! Does nothing for a type that is not owned by a TypePtr, e.g. a local copy
+    void remember_normalized(nodes::Context& context, const nodes::Type& type, bool normalize_pointers,
+                             nodes::TypePtr result);
+
+    //! Identities of a record and its bases from the root, nullptr if a base can't be resolved
+    const std::vector<TypeId>* display(nodes::Context& context, const nodes::RecordType& record);
+
+    //! Field table of a record including inherited fields, nullptr on error
+    const RecordLayout* fields(nodes::Context& context, const nodes::RecordType& record);
+    //! Size and alignment of a type; for records also fills the field offsets
+    Maybe<Layout> layout(nodes::Context& context, const nodes::Type& type);
+    //! Allows layout() to place the own fields of a record by decreasing alignment
+    void set_field_reordering(bool reorder) { m_reorder_fields = reorder; }
+
+    //! Report the layout of every declared record and array type as a note (--dump-layout)
+    static bool dump_enabled() noexcept { return s_dump_layout; }
+    static void enable_dump() noexcept { s_dump_layout = true; }
+    //! Notes size, alignment and field offsets of a type at place, its layout must be computed
+    void dump_layout(nodes::Context& context, CodePlace place, const nodes::Ident& name, const nodes::Type& type);
+
+private:
+    using Key = std::vector<std::uintptr_t>;
+    using ScopedType = std::pair<const nodes::Type*, const SymbolTable*>;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept;
+    };
+    struct ScopedTypeHash {
+        size_t operator()(const ScopedType& key) const noexcept;
+    };
+    struct Normalized {
+        std::shared_ptr<const nodes::Type> type;
+        nodes::TypePtr result;
+    };
+
+    TypeId intern(Key key);
+    TypeId signature(nodes::Context& context, const nodes::ProcedureType& type);
+    const nodes::RecordType* base_record(nodes::Context& context, const nodes::RecordType& record);
+    Maybe<Layout> record_layout(nodes::Context& context, const nodes::RecordType& record);
+    Maybe<Layout> array_layout(nodes::Context& context, const nodes::ArrayType& array);
+
+    static inline TypeInterner* s_current = nullptr;
+    static inline bool s_dump_layout = false;
+
+    std::unordered_map<ScopedType, TypeId, ScopedTypeHash> m_identities;
+    std::unordered_map<ScopedType, TypeId, ScopedTypeHash> m_canonicals;
+    std::unordered_map<ScopedType, Normalized, ScopedTypeHash> m_normalized[2];
+    std::unordered_map<TypeId, std::vector<TypeId>> m_displays;
+    std::unordered_map<TypeId, RecordLayout> m_records;
+    std::unordered_map<TypeId, Layout> m_arrays;
+    bool m_reorder_fields = false;
+    std::unordered_map<Key, char, KeyHash> m_structural;
+    std::unordered_map<size_t, char> m_strings;
+    std::unordered_map<nodes::Ident, char> m_imports;
+};
+
+/*!
+ * Calls func with the interner of the current load. Outside of module loading
+ * a temporary interner is used, so types are still compared structurally but
+ * nothing is cached between calls.
+ */
+template <class Func>
+inline auto with_interner(Func&& func) {
+    if (auto interner = TypeInterner::active(); interner) return func(*interner);
+    TypeInterner uncached;
+    return func(uncached);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "type.hpp"
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * Size and alignment of a type in bytes on a 64-bit target. Pointers,
+ * procedures and opaque types of definition modules (ImportTypeName) take
+ * one machine word: an opaque type is implemented outside of the compiled
+ * sources, so it is laid out as a reference to its value.
+ */
+struct Layout {
+    std::uint64_t size;
+    std::uint64_t align;
+};
+
+struct RecordField {
+    nodes::Ident name;
+    nodes::TypePtr type;
+    std::uint64_t offset; //!< Valid once the layout of the record is computed
+};
+
+/*!
+ * Field table of a record type. Inherited fields come first in the order of
+ * the extension chain, then the fields of the record itself in declaration
+ * order, so a record extension is a prefix-compatible layout of its base.
+ */
+struct RecordLayout {
+    const RecordField* find(const nodes::Ident& name) const {
+        if (auto it = index.find(name); it != index.end()) return &fields[it->second];
+        return nullptr;
+    }
+
+    std::vector<RecordField> fields;
+    std::unordered_map<nodes::Ident, std::uint32_t> index;
+    size_t inherited = 0;          //!< Number of fields taken from the base record
+    std::optional<Layout> layout;  //!< Size and alignment, computed on first request
+};
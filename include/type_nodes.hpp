@@ -6,24 +6,31 @@
 #include "internal_error.hpp"
 #include "node.hpp"
 #include "type.hpp"
+#include <array>
 
 namespace nodes {
 
 struct BuiltInType : Type {
+    static constexpr NodeKind node_kind = NodeKind::BuiltInType;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    virtual bool same(Context& context, const Type& other) const override;
-    virtual bool equal(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     virtual bool assignment_compatible(Context& context, const Type& expr) const override;
     bool equal_to(BaseType t) const;
-    BuiltInType() : type() {}
+    BuiltInType() : Type(node_kind), type() {}
     BuiltInType(std::string_view i);
     BuiltInType(BaseType t);
     BaseType type = BaseType::VOID;
 };
 
+//! Built-in types are immutable singletons shared by all modules, so they live on the heap for the whole
+//! process rather than in the arena of the module that first asks for them
 inline TypePtr make_base_type(BaseType t) {
-    return make_type<BuiltInType>(t);
+    static const std::array<TypePtr, size_t(BaseType::NIL) + 1> types = [] {
+        std::array<TypePtr, size_t(BaseType::NIL) + 1> result;
+        for (size_t i = 0; i < result.size(); ++i) result[i] = std::make_shared<BuiltInType>(BaseType(i));
+        return result;
+    }();
+    return types[size_t(t)];
 }
 
 inline bool is_base_type(Ident ident) {
@@ -34,14 +41,13 @@ inline bool is_base_type(Ident ident) {
 const char* basetype_to_str(BaseType type);
 
 struct TypeName : Type {
+    static constexpr NodeKind node_kind = NodeKind::TypeName;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    virtual bool same(Context& context, const Type& other) const override;
-    virtual bool equal(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     virtual bool assignment_compatible(Context& context, const Type& expr) const override;
     Maybe<TypePtr> dereference(Context& table) const;
-    TypeName() {}
-    TypeName(QualIdent i) : ident(i) {
+    TypeName() : Type(node_kind) {}
+    TypeName(QualIdent i) : Type(node_kind), ident(i) {
         if (!i.qual && is_base_type(i.ident))
             internal::compiler_error("BaseType in TypeName");
     }
@@ -49,12 +55,11 @@ struct TypeName : Type {
 };
 
 struct ImportTypeName : Type {
+    static constexpr NodeKind node_kind = NodeKind::ImportTypeName;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    virtual bool same(Context& context, const Type& other) const override;
-    virtual bool equal(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     virtual bool assignment_compatible(Context& context, const Type& expr) const override;
-    ImportTypeName(IdentDef i) : ident{{}, i.ident} {
+    ImportTypeName(IdentDef i) : Type(node_kind), ident{{}, i.ident} {
         if (!ident.qual && is_base_type(ident.ident))
             internal::compiler_error("BaseType in TypeName");
     }
@@ -64,45 +69,41 @@ struct ImportTypeName : Type {
 using FieldListSequence = std::vector<FieldList>;
 
 struct RecordType : Type {
+    static constexpr NodeKind node_kind = NodeKind::RecordType;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    virtual bool same(Context& context, const Type& other) const override;
-    virtual bool equal(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     virtual bool assignment_compatible(Context& context, const Type& expr) const override;
     Maybe<TypePtr> has_field(const Ident& ident, Context& table) const;
     bool extends(Context&, const Type&) const;
-    RecordType(std::optional<QualIdent> b, FieldListSequence s) : basetype(b), seq(s) {}
+    RecordType(std::optional<QualIdent> b, FieldListSequence s) : Type(node_kind), basetype(b), seq(s) {}
     std::optional<QualIdent> basetype;
     FieldListSequence seq;
 };
 
 struct PointerType : Type {
+    static constexpr NodeKind node_kind = NodeKind::PointerType;
     std::string to_string() const override;
     bool check_type(Context& table);
     const RecordType& get_type(Context&) const;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    virtual bool same(Context& context, const Type& other) const override;
-    virtual bool equal(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     virtual bool assignment_compatible(Context& context, const Type& expr) const override;
-    PointerType(TypePtr t) : type(t) {}
+    PointerType(TypePtr t) : Type(node_kind), type(t) {}
     TypePtr type;
 };
 
 struct ConstStringType : Type {
+    static constexpr NodeKind node_kind = NodeKind::ConstStringType;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    virtual bool same(Context& context, const Type& other) const override;
-    virtual bool equal(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     virtual bool assignment_compatible(Context& context, const Type& expr) const override;
-    ConstStringType(size_t s) : size(s) {}
+    ConstStringType(size_t s) : Type(node_kind), size(s) {}
     size_t size;
 };
 
 struct ArrayType : Type {
+    static constexpr NodeKind node_kind = NodeKind::ArrayType;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    virtual bool same(Context& context, const Type& other) const override;
-    virtual bool equal(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     virtual bool assignment_compatible(Context& context, const Type& expr) const override;
     Maybe<TypePtr> drop_dimensions(size_t, Context&) const;
     static bool compatible(Context&, const Type& actual, const Type& formal);
@@ -150,12 +151,11 @@ struct FormalParameters {
 };
 
 struct ProcedureType : Type {
+    static constexpr NodeKind node_kind = NodeKind::ProcedureType;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    virtual bool same(Context& context, const Type& other) const override;
-    virtual bool equal(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     virtual bool assignment_compatible(Context& context, const Type& expr) const override;
-    ProcedureType() {}
+    ProcedureType() : Type(node_kind) {}
     ProcedureType(std::optional<FormalParameters> par);
     FormalParameters params;
 };
@@ -198,18 +198,18 @@ struct CommonPair {
 };
 
 struct CommonType : Type {
+    static constexpr NodeKind node_kind = NodeKind::CommonType;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    bool same(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     bool equal(Context& context, const Type& other) const override;
     bool assignment_compatible(Context& context, const Type& expr) const override;
 
     bool has_case(CommonFeature feature) const;
     const Type& get_case(CommonFeature feature) const;
 
-    CommonType() {}
+    CommonType() : Type(node_kind) {}
     CommonType(std::optional<CommonFeatureType> cft, std::vector<CommonPair> pl, std::optional<TypePtr> ec)
-        : common_feature_type(cft), pair_list(pl), else_clause(ec) {}
+        : Type(node_kind), common_feature_type(cft), pair_list(pl), else_clause(ec) {}
 
     std::optional<CommonFeatureType> common_feature_type;
     std::vector<CommonPair> pair_list;
@@ -217,14 +217,14 @@ struct CommonType : Type {
 };
 
 struct ScalarType : Type {
+    static constexpr NodeKind node_kind = NodeKind::ScalarType;
     std::string to_string() const override;
-    Maybe<TypePtr> normalize(Context&, bool normalize_pointers) const override;
-    bool same(Context& context, const Type& other) const override;
+    Maybe<TypePtr> do_normalize(Context&, bool normalize_pointers) const override;
     bool equal(Context& context, const Type& other) const override;
     bool assignment_compatible(Context& context, const Type& expr) const override;
 
-    ScalarType() {}
-    ScalarType(TypePtr t, CommonFeature f) : type(t), feature(f) {}
+    ScalarType() : Type(node_kind) {}
+    ScalarType(TypePtr t, CommonFeature f) : Type(node_kind), type(t), feature(f) {}
 
     const Type& get_type() const { return type->is<CommonType>()->get_case(feature); }
 
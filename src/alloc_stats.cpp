@@ -0,0 +1,86 @@
+#include "alloc_stats.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace {
+
+AllocCounters g_counters;
+
+} // namespace
+
+bool alloc_stats::enabled() noexcept {
+#ifdef OBERON_ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocCounters alloc_stats::counters() noexcept {
+    return g_counters;
+}
+
+size_t alloc_stats::restart_peak() noexcept {
+    return std::exchange(g_counters.peak, g_counters.live);
+}
+
+void alloc_stats::merge_peak(size_t peak) noexcept {
+    g_counters.peak = std::max(g_counters.peak, peak);
+}
+
+#ifdef OBERON_ALLOC_STATS
+
+// Every block carries its size in a header so that unsized delete can
+// update the live byte count. The header keeps the default new alignment.
+namespace {
+
+constexpr size_t header_size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+void* counted_alloc(size_t size) noexcept {
+    auto block = static_cast<char*>(std::malloc(size + header_size));
+    if (!block) return nullptr;
+    *reinterpret_cast<size_t*>(block) = size;
+    g_counters.allocations++;
+    g_counters.bytes += size;
+    g_counters.live += size;
+    g_counters.peak = std::max(g_counters.peak, g_counters.live);
+    return block + header_size;
+}
+
+void counted_free(void* ptr) noexcept {
+    if (!ptr) return;
+    auto block = static_cast<char*>(ptr) - header_size;
+    g_counters.live -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    if (auto ptr = counted_alloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (auto ptr = counted_alloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+
+#endif
@@ -0,0 +1,40 @@
+#include "ast_stats.hpp"
+#include "libparser/format.hpp"
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+AstStats& AstStats::instance() noexcept {
+    static AstStats stats;
+    return stats;
+}
+
+void AstStats::print(std::ostream& stream) const {
+    std::vector<std::pair<std::string_view, size_t>> counts;
+    size_t total = 0;
+    for (size_t kind = 0; kind < m_counts.size(); ++kind) {
+        if (m_counts[kind] == 0) continue;
+        counts.emplace_back(FlatAst::kind_to_str(FlatAst::Kind(kind)), m_counts[kind]);
+        total += m_counts[kind];
+    }
+    std::ranges::sort(counts, [](auto& l, auto& r) {
+        return l.second > r.second || (l.second == r.second && l.first < r.first);
+    });
+    stream << format_color(Blue, "AST nodes:") << "\n";
+    stream << fmt::format("{:>12}  {}\n", "count", "node");
+    for (auto& [name, count] : counts) stream << fmt::format("{:>12}  {}\n", count, name);
+    stream << fmt::format("{:>12}  {}\n", total, "total");
+    if (std::ranges::any_of(m_case_dispatch, [](size_t count) { return count > 0; })) {
+        stream << format_color(Blue, "CASE dispatch:") << "\n";
+        stream << fmt::format("{:>12}  {}\n", m_case_dispatch[nodes::CaseDispatch::JUMP_TABLE], "jump table");
+        stream << fmt::format("{:>12}  {}\n", m_case_dispatch[nodes::CaseDispatch::BINARY_SEARCH], "binary search");
+        stream << fmt::format("{:>12}  {}\n", m_case_dispatch[nodes::CaseDispatch::BIT_TEST], "bit test");
+    }
+    auto calls = m_static_calls + m_base_calls + m_dynamic_calls;
+    if (calls == 0) return;
+    stream << format_color(Blue, "Multimethod calls:") << "\n";
+    stream << fmt::format("{:>12}  {}\n", m_static_calls, "static instance");
+    stream << fmt::format("{:>12}  {}\n", m_base_calls, "static base procedure");
+    stream << fmt::format("{:>12}  {}\n", m_dynamic_calls, "dynamic dispatch");
+    stream << fmt::format("{:>11.1f}%  {}\n", 100.0 * (m_static_calls + m_base_calls) / calls, "devirtualized");
+}
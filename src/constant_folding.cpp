@@ -0,0 +1,301 @@
+#include "constant_folding.hpp"
+#include "internal_error.hpp"
+#include "node_formatters.hpp"
+#include "symbol_table.hpp"
+#include <algorithm>
+#include <ranges>
+
+using namespace nodes;
+
+//! Copy of a literal value that can take the place of the folded expression, nullptr for other values
+inline ValuePtr copy_literal(const Value& value) {
+    switch (value.kind) {
+        case NodeKind::IntegerValue: return make_value<IntegerValue>(static_cast<const IntegerValue&>(value));
+        case NodeKind::RealValue:    return make_value<RealValue>(static_cast<const RealValue&>(value));
+        case NodeKind::CharValue:    return make_value<CharValue>(static_cast<const CharValue&>(value));
+        case NodeKind::StringValue:  return make_value<StringValue>(static_cast<const StringValue&>(value));
+        case NodeKind::NilValue:     return make_value<NilValue>(static_cast<const NilValue&>(value));
+        case NodeKind::BooleanValue: return make_value<BooleanValue>(static_cast<const BooleanValue&>(value));
+        case NodeKind::SetValue:     return make_value<SetValue>(static_cast<const SetValue&>(value));
+        default: return nullptr;
+    }
+}
+
+inline bool is_literal(const ExpressionPtr& expr) {
+    return expr->is<Value>() && !expr->is<BaseProcedureValue>();
+}
+
+inline StatementPtr placed(StatementPtr statement, CodePlace place) {
+    statement->place = place;
+    return statement;
+}
+
+//! The only arm whose labels contain a constant selector, none when the labels are not checked yet
+inline std::optional<size_t> selected_case(const CaseStatement& statement, const Value& selector) {
+    size_t label_index;
+    Integer value;
+    if (auto integer = selector.is<IntegerValue>(); integer) {
+        label_index = 0;
+        value = integer->value;
+    } else if (auto character = selector.is<CharValue>(); character) {
+        label_index = 1;
+        value = static_cast<unsigned char>(character->value);
+    } else {
+        return std::nullopt;
+    }
+    std::optional<size_t> result;
+    for (size_t branch = 0; branch < statement.cases.size(); branch++) {
+        for (auto& label : std::get<0>(statement.cases[branch])) {
+            if (label.first.index() != label_index || (label.second && label.second->index() != label_index))
+                return std::nullopt;
+            auto low = label_value(label.first);
+            auto high = label.second ? label_value(*label.second) : low;
+            if (value < low || value > high) continue;
+            // Overlapping labels are left to CaseStatement::check
+            if (result) return std::nullopt;
+            result = branch;
+        }
+    }
+    return result;
+}
+
+StatementSequence ConstantFolder::fold(const StatementSequence& seq) {
+    StatementSequence result;
+    result.reserve(seq.size());
+    for (auto& statement : seq) fold_statement(statement, result);
+    return result;
+}
+
+void ConstantFolder::fold_statement(const StatementPtr& statement, StatementSequence& out) {
+    switch (statement->kind) {
+        case NodeKind::Assignment: {
+            auto& assignment = static_cast<const Assignment&>(*statement);
+            auto value = fold(assignment.value);
+            if (value == assignment.value) out.push_back(statement);
+            else out.push_back(placed(make_statement<Assignment>(assignment.variable, value), statement->place));
+            return;
+        }
+        case NodeKind::IfStatement:
+            return fold_if(static_cast<const IfStatement&>(*statement), out);
+        case NodeKind::WhileStatement:
+            return fold_while(static_cast<const WhileStatement&>(*statement), out);
+        case NodeKind::CaseStatement:
+            return fold_case(static_cast<const CaseStatement&>(*statement), out);
+        case NodeKind::RepeatStatement: {
+            auto& [condition, block] = static_cast<const RepeatStatement&>(*statement).if_block;
+            out.push_back(placed(make_statement<RepeatStatement>(fold(block), fold(condition)), statement->place));
+            return;
+        }
+        case NodeKind::ForStatement: {
+            auto& loop = static_cast<const ForStatement&>(*statement);
+            std::optional<ExpressionPtr> by;
+            if (loop.by_expr) by = loop.by_expr->get_expression();
+            out.push_back(placed(make_statement<ForStatement>(loop.ident, fold(loop.for_expr), fold(loop.to_expr), by, fold(loop.block)),
+                                 statement->place));
+            return;
+        }
+        case NodeKind::CallStatement: {
+            auto& call = static_cast<const CallStatement&>(*statement);
+            auto expr = fold(call.call);
+            if (expr == call.call) out.push_back(statement);
+            else out.push_back(placed(make_statement<CallStatement>(expr), statement->place));
+            return;
+        }
+        default:
+            internal::compiler_error("Unexpected statement in ConstantFolder");
+    }
+}
+
+std::optional<bool> ConstantFolder::fold_condition(ExpressionPtr& condition) {
+    condition = fold(condition);
+    if (auto boolean = condition->is<BooleanValue>(); boolean) return boolean->value;
+    return std::nullopt;
+}
+
+void ConstantFolder::fold_if(const IfStatement& statement, StatementSequence& out) {
+    std::vector<IfBlock> blocks;
+    std::optional<StatementSequence> else_block;
+    std::vector<IfBlock> dead_blocks;
+    // Set once a condition is TRUE, its branch becomes the ELSE branch and the following ones never run
+    auto taken = false;
+    for (auto& [original, statements] : statement.if_blocks) {
+        if (taken) {
+            removed(original->place, "Removed branch {} after a TRUE condition", original);
+            dead_blocks.emplace_back(original, statements);
+            continue;
+        }
+        auto condition = original;
+        auto value = fold_condition(condition);
+        if (value && !*value) {
+            removed(original->place, "Removed branch with FALSE condition {}", original);
+            dead_blocks.emplace_back(original, statements);
+        } else if (value) {
+            taken = true;
+            else_block = fold(statements);
+        } else {
+            blocks.emplace_back(condition, fold(statements));
+        }
+    }
+    std::optional<StatementSequence> dead_else;
+    if (statement.else_block) {
+        if (taken) {
+            removed(statement.place, "Removed ELSE branch after a TRUE condition");
+            dead_else = statement.else_block;
+        } else {
+            else_block = fold(*statement.else_block);
+        }
+    }
+    if (!dead_blocks.empty())
+        m_pruned.push_back(placed(make_statement<IfStatement>(dead_blocks, dead_else), statement.place));
+    else if (dead_else)
+        m_pruned.insert(m_pruned.end(), dead_else->begin(), dead_else->end());
+    if (!blocks.empty()) {
+        out.push_back(placed(make_statement<IfStatement>(blocks, else_block), statement.place));
+    } else if (else_block) {
+        out.insert(out.end(), else_block->begin(), else_block->end());
+    }
+}
+
+void ConstantFolder::fold_while(const WhileStatement& statement, StatementSequence& out) {
+    std::vector<IfBlock> blocks;
+    std::vector<IfBlock> dead_blocks;
+    auto& if_blocks = statement.if_blocks;
+    for (size_t i = 0; i < if_blocks.size(); i++) {
+        auto& [original, statements] = if_blocks[i];
+        auto condition = original;
+        auto value = fold_condition(condition);
+        if (value && !*value) {
+            removed(original->place, "Removed loop branch with FALSE condition {}", original);
+            dead_blocks.push_back(if_blocks[i]);
+            continue;
+        }
+        blocks.emplace_back(condition, fold(statements));
+        // A loop branch with a TRUE condition runs forever, the following ones never run
+        if (value) {
+            for (auto& next : if_blocks | std::views::drop(i + 1)) {
+                removed(std::get<0>(next)->place, "Removed loop branch {} after a TRUE condition", std::get<0>(next));
+                dead_blocks.push_back(next);
+            }
+            break;
+        }
+    }
+    if (!dead_blocks.empty())
+        m_pruned.push_back(placed(make_statement<WhileStatement>(dead_blocks), statement.place));
+    if (!blocks.empty()) out.push_back(placed(make_statement<WhileStatement>(blocks), statement.place));
+}
+
+void ConstantFolder::fold_case(const CaseStatement& statement, StatementSequence& out) {
+    auto expression = fold(statement.expression);
+    if (auto selector = dyn_cast<Value>(expression.get()); selector) {
+        if (auto branch = selected_case(statement, *selector); branch) {
+            for (size_t i = 0; i < statement.cases.size(); i++) {
+                if (i == *branch) continue;
+                removed(statement.place, "Removed CASE arm {} not selected by {}", std::get<0>(statement.cases[i]), expression);
+            }
+            // All labels are still checked, the body of the selected arm is checked where it is inlined
+            auto dead_cases = statement.cases;
+            std::get<1>(dead_cases[*branch]).clear();
+            m_pruned.push_back(placed(make_statement<CaseStatement>(expression, dead_cases), statement.place));
+            auto statements = fold(std::get<1>(statement.cases[*branch]));
+            out.insert(out.end(), statements.begin(), statements.end());
+            return;
+        }
+    }
+    std::vector<Case> cases;
+    cases.reserve(statement.cases.size());
+    for (auto& [labels, statements] : statement.cases) cases.emplace_back(labels, fold(statements));
+    out.push_back(placed(make_statement<CaseStatement>(expression, cases), statement.place));
+}
+
+ExpressionPtr ConstantFolder::fold(const ExpressionPtr& expr) {
+    switch (expr->kind) {
+        case NodeKind::ProcCall: {
+            auto& call = static_cast<const ProcCall&>(*expr);
+            {
+                // A designator that can't be repaired is reported when the statement is checked
+                MessageContainer::Mute mute(m_context.messages);
+                if (!call.data.repair(m_context)) return expr;
+            }
+            auto& data = call.data.get();
+            if (!data.params) {
+                if (data.commonParams || !data.ident.get().selector.empty()) return expr;
+                // A constant is looked up once here, so its type is not checked before
+                return evaluate(expr, false);
+            }
+            auto params = *data.params;
+            auto changed = false;
+            for (auto& param : params) {
+                auto folded = fold(param);
+                changed |= folded != param;
+                param = folded;
+            }
+            if (!changed) return expr;
+            auto copy = std::static_pointer_cast<ProcCall>(make_expression<ProcCall>(call));
+            copy->data.get_mut().params = std::move(params);
+            return copy;
+        }
+        case NodeKind::BaseProcedureValue: {
+            auto& call = static_cast<const BaseProcedureValue&>(*expr);
+            auto params = call.params;
+            auto changed = false;
+            for (auto& param : params) {
+                auto folded = fold(param);
+                changed |= folded != param;
+                param = folded;
+            }
+            ExpressionPtr result = expr;
+            if (changed) {
+                auto copy = std::static_pointer_cast<BaseProcedureValue>(make_value<BaseProcedureValue>(call));
+                copy->params = params;
+                result = copy;
+            }
+            if (!std::ranges::all_of(params, is_literal)) return result;
+            return evaluate(result, true);
+        }
+        case NodeKind::Tilda: {
+            auto& tilda = static_cast<const Tilda&>(*expr);
+            auto operand = fold(tilda.expression);
+            ExpressionPtr result = expr;
+            if (operand != tilda.expression) {
+                result = make_expression<Tilda>(operand);
+                result->place = expr->place;
+            }
+            if (!is_literal(operand)) return result;
+            return evaluate(result, true);
+        }
+        case NodeKind::Term: {
+            auto& term = static_cast<const Term&>(*expr);
+            auto first = fold(term.first);
+            auto changed = first != term.first;
+            auto literal = is_literal(first);
+            auto operations = term.operations;
+            for (auto& operation : operations) {
+                auto folded = fold(operation.operand);
+                changed |= folded != operation.operand;
+                literal &= is_literal(folded);
+                operation.operand = folded;
+            }
+            ExpressionPtr result = expr;
+            if (changed) {
+                result = make_expression<Term>(term.sign, first, std::move(operations));
+                result->place = expr->place;
+            }
+            if (!literal) return result;
+            return evaluate(result, true);
+        }
+        default:
+            return expr;
+    }
+}
+
+ExpressionPtr ConstantFolder::evaluate(const ExpressionPtr& expr, bool check_type) {
+    // Whatever fails here is reported when the statement is checked
+    MessageContainer::Mute mute(m_context.messages);
+    if (check_type && !expr->get_type(m_context)) return expr;
+    auto value = expr->eval_constant(m_context);
+    if (!value) return expr;
+    auto literal = copy_literal(**value);
+    if (!literal) return expr;
+    literal->place = expr->place;
+    return literal;
+}
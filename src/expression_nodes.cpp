@@ -9,13 +9,19 @@
 #include "type.hpp"
 #include "type_nodes.hpp"
 #include "symbol_table.hpp"
+#include "multimethod_table.hpp"
+#include "ast_stats.hpp"
 #include <cmath>
 #include <initializer_list>
+#include <limits>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <ranges>
+#include <span>
 
 using namespace nodes;
 
@@ -37,7 +43,7 @@ Maybe<ValuePtr> incompatible_types(Context& context, OpType oper, const Value& l
     if (!left_res || !right_res) return error;
     auto [left_group, left_type] = left_res.value();
     auto [right_group, right_type] = right_res.value();
-    context.messages.addErr(left.place, "Incompatible types for operator '{}' : {} and {}", optype_to_str(oper), left_type->to_string(), right_type->to_string());
+    context.messages.addErr(left.place, "Incompatible types for operator '{}' : {} and {}", optype_to_str(oper), *left_type, *right_type);
     return error;
 }
 
@@ -252,190 +258,163 @@ Maybe<ValuePtr> SetValue::apply_operator(Context& context, OpType oper, const Va
     }
 }
 
-constexpr const char* show_bptype(BPType type) {
-    switch (type) {
-        case BPType::ABS:    return "ABS";
-        case BPType::ODD:    return "ODD";
-        case BPType::LEN:    return "LEN";
-        case BPType::LSL:    return "LSL";
-        case BPType::ASR:    return "ASR";
-        case BPType::ROR:    return "ROR";
-        case BPType::FLOOR:  return "FLOOR";
-        case BPType::FLT:    return "FLT";
-        case BPType::ORD:    return "ORD";
-        case BPType::CHR:    return "CHR";
-        case BPType::INC:    return "INC";
-        case BPType::DEC:    return "DEC";
-        case BPType::INCL:   return "INCL";
-        case BPType::EXCL:   return "EXCL";
-        case BPType::NEW:    return "NEW";
-        case BPType::ASSERT: return "ASSERT";
-        case BPType::PACK:   return "PACK";
-        case BPType::UNPK:   return "UNPK";
-        default: internal::compiler_error(__FUNCTION__);
-    }
-}
+namespace {
 
-BPType read_bptype(std::string_view type) {
-    if (type == show_bptype(BPType::ABS))    return BPType::ABS;
-    if (type == show_bptype(BPType::ODD))    return BPType::ODD;
-    if (type == show_bptype(BPType::LEN))    return BPType::LEN;
-    if (type == show_bptype(BPType::LSL))    return BPType::LSL;
-    if (type == show_bptype(BPType::ASR))    return BPType::ASR;
-    if (type == show_bptype(BPType::ROR))    return BPType::ROR;
-    if (type == show_bptype(BPType::FLOOR))  return BPType::FLOOR;
-    if (type == show_bptype(BPType::FLT))    return BPType::FLT;
-    if (type == show_bptype(BPType::ORD))    return BPType::ORD;
-    if (type == show_bptype(BPType::CHR))    return BPType::CHR;
-    if (type == show_bptype(BPType::INC))    return BPType::INC;
-    if (type == show_bptype(BPType::DEC))    return BPType::DEC;
-    if (type == show_bptype(BPType::INCL))   return BPType::INCL;
-    if (type == show_bptype(BPType::EXCL))   return BPType::EXCL;
-    if (type == show_bptype(BPType::NEW))    return BPType::NEW;
-    if (type == show_bptype(BPType::ASSERT)) return BPType::ASSERT;
-    if (type == show_bptype(BPType::PACK))   return BPType::PACK;
-    if (type == show_bptype(BPType::UNPK))   return BPType::UNPK;
-    internal::compiler_error(__FUNCTION__);
-}
+//! How an argument of a built-in procedure is checked
+enum class ArgKind : uint8_t {
+    EXACT,   //!< Expression of the single listed built-in type
+    BASE,    //!< Expression of one of the listed built-in types
+    ARRAY,   //!< Array or string
+    POINTER  //!< Pointer
+};
 
-std::string BaseProcedureValue::to_string() const {
-    return fmt::format("{}({})", show_bptype(name), params);
-}
+struct ArgRule {
+    ArgKind kind;
+    bool var;
+    uint8_t type_count = 0;
+    std::array<BaseType, 3> types = {};
+};
 
-inline bool expect_params_count(Context& context, const BaseProcedureValue& proc, std::initializer_list<size_t> count) {
-    if (std::ranges::find(count, proc.params.size()) == count.end()) {
-        std::vector count_vector(count);
-        context.messages.addErr(proc.place, "Expected {} parameters, found {}", fmt::join(count_vector, " or "), proc.params.size());
-        return berror;
-    }
-    return bsuccess;
+constexpr size_t max_builtin_params = 2;
+
+struct BuiltinSignature {
+    BPType type;
+    std::string_view name;
+    uint8_t min_params;
+    uint8_t max_params;
+    std::array<ArgRule, max_builtin_params> args;
+    BaseType result; //!< VOID for proper procedures
+    bool result_of_first = false; //!< The result has the type of the first argument
+};
+
+constexpr ArgRule exact(BaseType type) { return {ArgKind::EXACT, false, 1, {type}}; }
+constexpr ArgRule base(BaseType type, bool var = false) { return {ArgKind::BASE, var, 1, {type}}; }
+constexpr ArgRule base(BaseType first, BaseType second, BaseType third) {
+    return {ArgKind::BASE, false, 3, {first, second, third}};
+}
+
+//! Signatures of all built-in procedures in BPType order
+constexpr BuiltinSignature builtins[] = {
+    {BPType::ABS,    "ABS",    1, 1, {base(BaseType::INTEGER, BaseType::BYTE, BaseType::REAL)}, BaseType::VOID, true},
+    {BPType::ODD,    "ODD",    1, 1, {exact(BaseType::INTEGER)}, BaseType::BOOL},
+    {BPType::LEN,    "LEN",    1, 1, {ArgRule{ArgKind::ARRAY, false}}, BaseType::INTEGER},
+    {BPType::LSL,    "LSL",    2, 2, {exact(BaseType::INTEGER), exact(BaseType::INTEGER)}, BaseType::INTEGER},
+    {BPType::ASR,    "ASR",    2, 2, {exact(BaseType::INTEGER), exact(BaseType::INTEGER)}, BaseType::INTEGER},
+    {BPType::ROR,    "ROR",    2, 2, {exact(BaseType::INTEGER), exact(BaseType::INTEGER)}, BaseType::INTEGER},
+    {BPType::FLOOR,  "FLOOR",  1, 1, {exact(BaseType::REAL)}, BaseType::INTEGER},
+    {BPType::FLT,    "FLT",    1, 1, {exact(BaseType::INTEGER)}, BaseType::REAL},
+    {BPType::ORD,    "ORD",    1, 1, {base(BaseType::CHAR, BaseType::BOOL, BaseType::SET)}, BaseType::INTEGER},
+    {BPType::CHR,    "CHR",    1, 1, {exact(BaseType::INTEGER)}, BaseType::CHAR},
+    {BPType::INC,    "INC",    1, 2, {base(BaseType::INTEGER, true), base(BaseType::INTEGER)}, BaseType::VOID},
+    {BPType::DEC,    "DEC",    1, 2, {base(BaseType::INTEGER, true), base(BaseType::INTEGER)}, BaseType::VOID},
+    {BPType::INCL,   "INCL",   2, 2, {base(BaseType::SET, true), base(BaseType::INTEGER)}, BaseType::VOID},
+    {BPType::EXCL,   "EXCL",   2, 2, {base(BaseType::SET, true), base(BaseType::INTEGER)}, BaseType::VOID},
+    {BPType::NEW,    "NEW",    1, 1, {ArgRule{ArgKind::POINTER, true}}, BaseType::VOID},
+    {BPType::ASSERT, "ASSERT", 1, 1, {base(BaseType::BOOL)}, BaseType::VOID},
+    {BPType::PACK,   "PACK",   2, 2, {base(BaseType::REAL, true), base(BaseType::INTEGER)}, BaseType::VOID},
+    {BPType::UNPK,   "UNPK",   2, 2, {base(BaseType::REAL, true), base(BaseType::INTEGER, true)}, BaseType::VOID},
+};
+
+constexpr bool builtins_in_order() {
+    for (size_t i = 0; i < std::size(builtins); i++)
+        if (size_t(builtins[i].type) != i) return false;
+    return true;
 }
+static_assert(builtins_in_order());
 
-inline bool expect_params_count(Context& context, const BaseProcedureValue& proc, size_t count) {
-    return expect_params_count(context, proc, {count});
+//! Perfect hash of built-in names, the constants are chosen so that all names get distinct slots
+constexpr size_t builtin_slot(std::string_view name) {
+    return (2 * name[0] + 11 * name[1] + name.back() + 2 * name.size()) % 32;
 }
 
-inline bool exprect_var(Context& context, const BaseProcedureValue& proc, std::vector<std::pair<SymbolGroup, TypePtr>> types, size_t index) {
-    if (types[index].first != SymbolGroup::VAR) {
-        context.messages.addErr(proc.params[index]->place, "Expected variable");
-        return berror;
+using BuiltinSlots = std::array<int8_t, 32>;
+
+constexpr BuiltinSlots make_builtin_slots() {
+    BuiltinSlots slots{};
+    slots.fill(-1);
+    for (size_t i = 0; i < std::size(builtins); i++) {
+        auto& slot = slots[builtin_slot(builtins[i].name)];
+        if (slot != -1) throw "builtin_slot is not a perfect hash";
+        slot = int8_t(i);
     }
-    return bsuccess;
+    return slots;
 }
 
-template <class... Types>
-requires (std::convertible_to<Types, bool> && ...)
-bool many_and(Types... args) {
-    return (true && ... && args);
+constexpr BuiltinSlots builtin_slots = make_builtin_slots();
+
+const BuiltinSignature& signature_of(BPType type) {
+    return builtins[size_t(type)];
 }
 
-template <class... Type>
-inline bool expect_type(Context& context, const BaseProcedureValue& proc, std::vector<std::pair<SymbolGroup, TypePtr>> types, size_t index, std::string_view descr) {
-    if (many_and(!types[index].second->is<Type>()...)) {
-        context.messages.addErr(proc.params[index]->place, "Expected {}", descr);
+bool check_argument(Context& context, const ExpressionPtr& param, const ArgRule& rule, const std::pair<SymbolGroup, TypePtr>& arg) {
+    auto& [group, type] = arg;
+    if (rule.var && group != SymbolGroup::VAR) {
+        context.messages.addErr(param->place, "Expected variable");
         return berror;
     }
-    return bsuccess;
+    auto types = std::span(rule.types.data(), rule.type_count);
+    auto base_type = type->is<BuiltInType>();
+    switch (rule.kind) {
+        case ArgKind::EXACT:
+            if (!base_type) {
+                context.messages.addErr(param->place, "Expected expression of built-in type");
+                return berror;
+            }
+            if (base_type->type != types[0]) {
+                context.messages.addErr(param->place, "Expected expression of {} type", basetype_to_str(types[0]));
+                return berror;
+            }
+            return bsuccess;
+        case ArgKind::BASE:
+            if (base_type && std::ranges::find(types, base_type->type) != types.end()) return bsuccess;
+            context.messages.addErr(param->place, "Expected {}", fmt::join(std::views::transform(types, basetype_to_str), " or "));
+            return berror;
+        case ArgKind::ARRAY:
+            if (type->is<ArrayType>() || type->is<ConstStringType>()) return bsuccess;
+            context.messages.addErr(param->place, "Expected array type");
+            return berror;
+        case ArgKind::POINTER:
+            if (type->is<PointerType>()) return bsuccess;
+            context.messages.addErr(param->place, "Expected pointer type");
+            return berror;
+        default:
+            internal::compiler_error(__FUNCTION__);
+    }
 }
 
-inline bool expect_base_type(Context& context, const BaseProcedureValue& proc,  std::vector<std::pair<SymbolGroup, TypePtr>> types, size_t index, std::initializer_list<BaseType> base_types) {
-    if (auto type = types[index].second->is<BuiltInType>(); type) {
-        if (std::ranges::find(base_types, type->type) != base_types.end()) return true;
-    }
-    auto type_strings = std::views::transform(base_types, basetype_to_str);
-    context.messages.addErr(proc.params[index]->place, "Expected {}", fmt::join(type_strings, " or "));
-    return berror;
+} // namespace
+
+BPType read_bptype(std::string_view type) {
+    auto index = builtin_slots[builtin_slot(type)];
+    if (index < 0 || builtins[index].name != type) internal::compiler_error(__FUNCTION__);
+    return builtins[index].type;
 }
 
-inline bool expect_base_type(Context& context, const BaseProcedureValue& proc,  std::vector<std::pair<SymbolGroup, TypePtr>> types, size_t index, BaseType base_type) {
-    return expect_base_type(context, proc, types, index, {base_type});
+std::string BaseProcedureValue::to_string() const {
+    return fmt::format("{}({})", signature_of(name).name, params);
 }
 
 Maybe<std::pair<SymbolGroup, TypePtr>> BaseProcedureValue::get_type(Context& context) const {
-    std::vector<std::pair<SymbolGroup, TypePtr>> params_types;
+    auto& signature = signature_of(name);
+    std::array<std::pair<SymbolGroup, TypePtr>, max_builtin_params> args;
     bool param_error = false;
-    for (auto param : params) {
-        auto param_type = param->get_type(context);
+    for (size_t i = 0; i < params.size(); i++) {
+        auto param_type = params[i]->get_type(context);
         if (!param_type) param_error = true;
-        if (!param_error) params_types.push_back(param_type.value());
+        if (!param_error && i < args.size()) args[i] = std::move(param_type.value());
     }
     if (param_error) return error;
-    const std::vector<std::tuple<BPType, std::vector<BaseType>, BaseType>> proc_templates = {
-        {BPType::ODD, {BaseType::INTEGER}, BaseType::BOOL},
-        {BPType::LSL, {BaseType::INTEGER, BaseType::INTEGER}, BaseType::INTEGER},
-        {BPType::ASR, {BaseType::INTEGER, BaseType::INTEGER}, BaseType::INTEGER},
-        {BPType::ROR, {BaseType::INTEGER, BaseType::INTEGER}, BaseType::INTEGER},
-        {BPType::FLOOR, {BaseType::REAL}, BaseType::INTEGER},
-        {BPType::FLT, {BaseType::INTEGER}, BaseType::REAL},
-        {BPType::CHR, {BaseType::INTEGER}, BaseType::CHAR}
-    };
-    auto templ_it = std::ranges::find_if(proc_templates, [this](auto& templ){ return std::get<0>(templ) == name; });
-    if (templ_it != proc_templates.end()) {
-        auto templ_params = std::get<1>(*templ_it);
-        if (!expect_params_count(context, *this, templ_params.size())) return error;
-        for (size_t i = 0; i < templ_params.size(); ++i) {
-            auto [group, type] = params_types[i];
-            auto base_type = type->is<BuiltInType>();
-            if (!base_type) {
-                context.messages.addErr(params[i]->place, "Expected expression of built-in type");
-                return error;
-            }
-            if (base_type->type != templ_params[i]) {
-                context.messages.addErr(params[i]->place, "Expected expression of {} type", basetype_to_str(templ_params[i]));
-                return error;
-            }
-        }
-        return std::pair(SymbolGroup::CONST, make_base_type(std::get<2>(*templ_it)));
-    }
-    if (name == BPType::ABS) {
-        if (!expect_params_count(context, *this, 1)) return error;
-        if (!expect_base_type(context, *this, params_types, 0, {BaseType::INTEGER, BaseType::BYTE, BaseType::REAL})) return error;
-        return std::pair(SymbolGroup::CONST, params_types[0].second);
-    }
-    if (name == BPType::LEN) {
-        if (!expect_params_count(context, *this, 1)) return error;
-        // if (!exprect_var(context, *this, params_types, 0)) return error; //Действительно ли это нужно?
-        if (!expect_type<ArrayType, ConstStringType>(context, *this, params_types, 0, "array type")) return error;
-        return std::pair(SymbolGroup::CONST, make_type<BuiltInType>(BaseType::INTEGER));
-    }
-    if (name == BPType::ORD) {
-        if (!expect_params_count(context, *this, 1)) return error;
-        if (!expect_base_type(context, *this, params_types, 0, {BaseType::CHAR, BaseType::BOOL, BaseType::SET})) return error;
-        return std::pair(SymbolGroup::CONST, make_type<BuiltInType>(BaseType::INTEGER));
-    }
-    if (name == BPType::INC || name == BPType::DEC) {
-        if (!expect_params_count(context, *this, {1,2})) return error;
-        if (!exprect_var(context, *this, params_types, 0)) return error;
-        if (!expect_base_type(context, *this, params_types, 0, BaseType::INTEGER)) return error;
-        if (params.size() == 2 && !expect_base_type(context, *this, params_types, 1, BaseType::INTEGER)) return error;
-        return std::pair(SymbolGroup::CONST, make_base_type(BaseType::VOID));
-    }
-    if (name == BPType::INCL || name ==BPType::EXCL) {
-        if (!expect_params_count(context, *this, 2)) return error;
-        if (!exprect_var(context, *this, params_types, 0)) return error;
-        if (!expect_base_type(context, *this, params_types, 0, BaseType::SET)) return error;
-        if (!expect_base_type(context, *this, params_types, 1, BaseType::INTEGER)) return error;
-        return std::pair(SymbolGroup::CONST, make_base_type(BaseType::VOID));
-    }
-    if (name == BPType::NEW) {
-        if (!expect_params_count(context, *this, 1)) return error;
-        if (!exprect_var(context, *this, params_types, 0)) return error;
-        if (!expect_type<PointerType>(context, *this, params_types, 0, "pointer type")) return error;
-        return std::pair(SymbolGroup::CONST, make_base_type(BaseType::VOID));
-    }
-    if (name == BPType::ASSERT) {
-        if (!expect_params_count(context, *this, 1)) return error;
-        if (!expect_base_type(context, *this, params_types, 0, BaseType::BOOL)) return error;
-        return std::pair(SymbolGroup::CONST, make_base_type(BaseType::VOID));
-    }
-    if (name == BPType::PACK || name == BPType::UNPK) {
-        if (!expect_params_count(context, *this, 1)) return error;
-        if (!exprect_var(context, *this, params_types, 0)) return error;
-        if (!expect_base_type(context, *this, params_types, 0, BaseType::REAL)) return error;
-        if (!expect_base_type(context, *this, params_types, 1, BaseType::INTEGER)) return error;
-        return std::pair(SymbolGroup::CONST, make_base_type(BaseType::VOID));
+    if (params.size() < signature.min_params || params.size() > signature.max_params) {
+        auto counts = fmt::format("{}", signature.min_params);
+        for (auto count = signature.min_params + 1; count <= signature.max_params; count++)
+            counts += fmt::format(" or {}", count);
+        context.messages.addErr(place, "Expected {} parameters, found {}", counts, params.size());
+        return error;
     }
-    internal::compiler_error(__FUNCTION__);
+    for (size_t i = 0; i < params.size(); i++)
+        if (!check_argument(context, params[i], signature.args[i], args[i])) return error;
+    if (signature.result_of_first) return std::pair(SymbolGroup::CONST, args[0].second);
+    return std::pair(SymbolGroup::CONST, make_base_type(signature.result));
 }
 
 Maybe<ValuePtr> BaseProcedureValue::eval_constant(Context& context) const {
@@ -508,7 +487,7 @@ Maybe<ValuePtr> BaseProcedureValue::apply_operator(Context& context, OpType oper
     return this_value.value()->apply_operator(context, oper, other);
 }
 
-BaseProcedureValue::BaseProcedureValue(std::string_view n, ExpList p) : name(read_bptype(n)), params(p) {}
+BaseProcedureValue::BaseProcedureValue(std::string_view n, ExpList p) : Value(node_kind), name(read_bptype(n)), params(p) {}
 
 std::string Set::to_string() const {
     return fmt::format("{{{}}}", fmt::join(value, ", "));
@@ -555,7 +534,7 @@ Maybe<ValuePtr> Set::eval_constant(Context& context) const {
     return make_value<SetValue>(set);
 }
 
-Set::Set(std::optional<std::vector<SetElement>> v) {
+Set::Set(std::optional<std::vector<SetElement>> v) : Expression(node_kind) {
     if (v)
         value = *v;
 }
@@ -582,66 +561,78 @@ inline Maybe<const RecordType*> get_record_from_pointer(const Type* some_type, C
     }
     auto type = some_type->is<RecordType>();
     if (!type) {
-        context.messages.addErr(place, "Expected record, pointer or scalar type, found {}", start_type->to_string());
+        context.messages.addErr(place, "Expected record, pointer or scalar type, found {}", *start_type);
         return error;
     }
     return type;
 }
 
+bool Designator::bind(const SymbolTable& scope) const {
+    if (ident.qual) return false;
+    if (m_bound_scope == scope.id()) return true;
+    auto binding = scope.bind(ident.ident);
+    if (!binding) return false;
+    m_bound_scope = scope.id();
+    m_binding = *binding;
+    return true;
+}
+
 Maybe<SymbolToken> Designator::get_symbol(Context& context, CodePlace place) const {
-    auto res = context.symbols.get_symbol(context.messages, ident);
-    if (!res) {
-        return error;
+    Maybe<SymbolToken> res;
+    if (bind(context.symbols)) {
+        res = context.symbols.bound_symbol(m_binding);
     } else {
-        auto symbol = *res;
-        for (auto& sel : selector) {
-            auto symbolType = symbol.type;
-            if (symbol.group == SymbolGroup::TYPE) {
-                context.messages.addErr(place, "Unexpected type name {}", symbol.name);
+        res = context.symbols.get_symbol(context.messages, ident);
+        if (!res) return error;
+    }
+    if (selector.empty()) return res;
+    auto& selected = *res;
+    for (auto& sel : selector) {
+        if (selected.group == SymbolGroup::TYPE) {
+            context.messages.addErr(place, "Unexpected type name {}", selected.name);
+            return error;
+        }
+        if (auto ident = std::get_if<Ident>(&sel); ident) {
+            auto typeRes = get_record_from_pointer(selected.type.get(), context, place);
+            if (!typeRes)
+                return error;
+            auto type = *typeRes;
+            if (auto fType = type->has_field(*ident, context); fType) {
+                selected.type = *fType;
+            } else {
+                context.messages.addErr(place, "Field {} not found in record {}", *ident, *type);
                 return error;
             }
-            if (auto ident = std::get_if<Ident>(&sel); ident) {
-                auto typeRes = get_record_from_pointer(symbol.type.get(), context, place);
-                if (!typeRes)
-                    return error;
-                auto type = *typeRes;
-                if (auto fType = type->has_field(*ident, context); fType) {
-                    symbol.type = *fType;
-                } else {
-                    context.messages.addErr(place, "Field {} not found in record {}", *ident, type->to_string());
-                    return error;
-                }
-            } else if (auto ident = std::get_if<ExpList>(&sel); ident) {
-                auto ltype = dynamic_cast<ArrayType*>(symbol.type.get());
-                if (auto ntype = ltype->drop_dimensions(ident->size(), context); ntype) {
-                    symbol.type = *ntype;
-                } else {
-                    return error;
-                }
-            } else if (auto ident = std::get_if<char>(&sel); ident) {
-                auto type = dynamic_cast<PointerType*>(symbol.type.get());
-                if (type) {
-                    symbol.type = type->type;
-                } else {
-                    context.messages.addErr(place, "Expected pointer type, found {}", symbol.type->to_string());
-                    return error;
-                }
-            } else if (auto ident = std::get_if<QualIdent>(&sel); ident) {
-                auto typeSymbol = context.symbols.get_symbol(context.messages, *ident);
-                if (!typeSymbol) return error;
-                if (symbol.type->assignment_compatible(context, *typeSymbol->type)) {
-                    symbol.type = typeSymbol->type;
-                } else {
-                    context.messages.addErr(place, "'{}' is not an extension of '{}'", typeSymbol->type->to_string(), symbol.type->to_string());
-                    return error;
-                }
+        } else if (auto ident = std::get_if<ExpList>(&sel); ident) {
+            auto ltype = dyn_cast<ArrayType>(selected.type.get());
+            if (auto ntype = ltype->drop_dimensions(ident->size(), context); ntype) {
+                selected.type = *ntype;
             } else {
-                context.messages.addErr(place, "Internal compiler error in ProcCall::get_type");
                 return error;
             }
+        } else if (auto ident = std::get_if<char>(&sel); ident) {
+            auto type = dyn_cast<PointerType>(selected.type.get());
+            if (type) {
+                selected.type = type->type;
+            } else {
+                context.messages.addErr(place, "Expected pointer type, found {}", *selected.type);
+                return error;
+            }
+        } else if (auto ident = std::get_if<QualIdent>(&sel); ident) {
+            auto typeSymbol = context.symbols.get_symbol(context.messages, *ident);
+            if (!typeSymbol) return error;
+            if (selected.type->assignment_compatible(context, *typeSymbol->type)) {
+                selected.type = typeSymbol->type;
+            } else {
+                context.messages.addErr(place, "'{}' is not an extension of '{}'", *typeSymbol->type, *selected.type);
+                return error;
+            }
+        } else {
+            context.messages.addErr(place, "Internal compiler error in ProcCall::get_type");
+            return error;
         }
-        return symbol;
     }
+    return res;
 }
 
 bool nodes::designator_repair(Designator& value, Context& context) {
@@ -707,20 +698,53 @@ std::string ProcCall::to_string() const {
     }
 }
 
+/*!
+ * Resolves a call of a multimethod declared in the current module. When every
+ * common argument has a scalar type the instance is known at compile time,
+ * otherwise some case is only known at run time and the call is dispatched
+ * through the multimethod's dispatch table.
+ */
+inline void bind_multimethod(Context& context, const ProcCall& call, const Designator& ident, const std::vector<TypePtr>& common_types) {
+    if (call.multimethod || !ident.selector.empty()) return;
+    auto table = context.symbols.get_table(context.messages, ident.ident, true);
+    if (!table) return;
+    auto multimethod = dynamic_cast<const MultimethodTable*>(table->get());
+    if (!multimethod) return;
+    std::vector<size_t> cases;
+    for (size_t i = 0; i < common_types.size(); ++i) {
+        auto type = common_types[i];
+        if (auto name = type->is<TypeName>(); name) {
+            auto resolved = name->dereference(context);
+            if (!resolved) return;
+            type = *resolved;
+        }
+        auto scalar = type->is<ScalarType>();
+        auto index = scalar ? multimethod->case_index(i, scalar->feature) : std::nullopt;
+        if (!index) {
+            call.multimethod = MultimethodBinding{MultimethodBinding::DYNAMIC, nullptr};
+            break;
+        }
+        cases.push_back(*index);
+    }
+    if (!call.multimethod)
+        call.multimethod = MultimethodBinding{MultimethodBinding::STATIC, multimethod->instance_for(cases)};
+    if (AstStats::enabled()) AstStats::instance().count_call(*call.multimethod);
+}
+
 Maybe<std::pair<SymbolGroup, TypePtr>> ProcCall::get_type(Context& context) const {
     if (!data.repair(context)) return error;
-    auto ident = data.get().ident.get();
+    auto& ident = data.get().ident.get();
     auto params = data.get().params;
     auto commonParams = data.get().commonParams;
     auto symbolRes = ident.get_symbol(context, place);
     if (!symbolRes)
         return error;
-    auto symbol = *symbolRes;
+    auto& symbol = *symbolRes;
     if (!params && !commonParams) return std::pair(symbol.group, symbol.type);
 
-    auto funcType = dynamic_cast<ProcedureType*>(symbol.type.get());
+    auto funcType = dyn_cast<ProcedureType>(symbol.type.get());
     if (!funcType) {
-        context.messages.addErr(place, "Expected procedure type, found {}", symbol.type.get()->to_string());
+        context.messages.addErr(place, "Expected procedure type, found {}", *symbol.type);
         return error;
     }
     if (params && params->size() != funcType->params.formal.size()) {
@@ -744,11 +768,12 @@ Maybe<std::pair<SymbolGroup, TypePtr>> ProcCall::get_type(Context& context) cons
                 compatible_types = false;
             }
             if (!var.type->assignment_compatible(context, *exprType) && !ArrayType::compatible(context, *exprType, *var.type)) {
-                context.messages.addErr(place, "Can't match actual and formal parameter: {} and {}", exprType->to_string(), var.type->to_string());
+                context.messages.addErr(place, "Can't match actual and formal parameter: {} and {}", *exprType, *var.type);
                 compatible_types = false;
             }
         }
     }
+    std::vector<TypePtr> common_types;
     if (commonParams) {
         for (size_t i = 0; i < funcType->params.common.size(); ++i) {
             auto var = funcType->params.common[i];
@@ -756,12 +781,13 @@ Maybe<std::pair<SymbolGroup, TypePtr>> ProcCall::get_type(Context& context) cons
             auto valueSymbol = context.symbols.get_symbol(context.messages, value);
             if (!valueSymbol) return error;
             auto valueType = valueSymbol.value().type;
+            common_types.push_back(valueType);
             if (var.var && valueSymbol->group != SymbolGroup::VAR) {
                 context.messages.addErr(value.ident.place, "Expected variable");
                 compatible_types = false;
             }
             if (!var.type->assignment_compatible(context, *valueType) && !ArrayType::compatible(context, *valueType, *var.type)) {
-                context.messages.addErr(place, "Can't match actual and common parameter: {} and {}", valueType->to_string(), var.type->to_string());
+                context.messages.addErr(place, "Can't match actual and common parameter: {} and {}", *valueType, *var.type);
                 compatible_types = false;
             }
         }
@@ -769,6 +795,7 @@ Maybe<std::pair<SymbolGroup, TypePtr>> ProcCall::get_type(Context& context) cons
     if (!compatible_types) {
         return error;
     }
+    if (commonParams) bind_multimethod(context, *this, ident, common_types);
     TypePtr return_type = make_base_type(BaseType::VOID);
     if (funcType->params.rettype) return_type = *funcType->params.rettype;
     return std::pair(SymbolGroup::CONST, return_type);
@@ -781,7 +808,7 @@ Maybe<ValuePtr> ProcCall::eval_constant(Context& context) const {
     if (!data.get().commonParams && !data.get().params && ident.selector.size() == 0) {
         return context.symbols.get_value(context.messages, ident.ident);
     }
-    context.messages.addErr(place, "Selection sequence cannot be constant: {}", this->to_string());
+    context.messages.addErr(place, "Selection sequence cannot be constant: {}", *this);
     return error;
 }
 
@@ -798,7 +825,7 @@ Maybe<std::pair<SymbolGroup, TypePtr>> Tilda::get_type(Context& context) const {
     if (auto base = type->is<BuiltInType>(); base && base->equal_to(BaseType::BOOL))
         return *exprRes;
     else {
-        context.messages.addErr(place, "Expected Boolean, found {}", type->to_string());
+        context.messages.addErr(place, "Expected Boolean, found {}", *type);
         return error;
     }
 }
@@ -807,7 +834,7 @@ Maybe<ValuePtr> Tilda::eval_constant(Context& context) const {
     auto res = expression->eval_constant(context);
     if (!res)
         return error;
-    auto boolean = dynamic_cast<BooleanValue*>(res->get());
+    auto boolean = dyn_cast<BooleanValue>(res->get());
     if (!boolean) {
         context.messages.addErr(place, "Expected boolean");
         return error;
@@ -860,104 +887,112 @@ const char* nodes::optype_to_str(OpType type) {
 Operator::Operator(Ident v) : value(ident_to_optype({v.value.data(), v.value.size()})) {}
 Operator::Operator(std::string_view v) : value(ident_to_optype(v)) {}
 
-inline bool same_or(Context& context, const Type& expr, const Type& type1, const Type& type2) {
-    return expr.same(context, type1) || expr.same(context, type2);
-}
+namespace {
 
-inline bool same_or_base(Context& context, const Type& expr, BaseType type1, BaseType type2) {
-    return  same_or(context, expr, BuiltInType(type1), BuiltInType(type2));
+constexpr unsigned base_set(std::initializer_list<BaseType> types) {
+    unsigned set = 0;
+    for (auto type : types) set |= 1u << unsigned(type);
+    return set;
 }
 
-struct OpTableSubLine {
-    std::vector<BaseType> first;
-    std::vector<BaseType> second;
+constexpr auto INTEGERS = base_set({BaseType::INTEGER, BaseType::BYTE});
+
+struct OpRule {
+    OpType opers;
+    unsigned first;
+    unsigned second;
     BaseType result;
 };
 
-struct OpTableLine {
-    std::vector<OpType> oper;
-    std::vector<OpTableSubLine> sublines;
+//! Typing rules for operators on basic types; the first matching rule wins
+constexpr OpRule oprules[] = {
+    {OP_ADD | OP_SUB | OP_MUL, INTEGERS, INTEGERS, BaseType::INTEGER},
+    {OP_ADD | OP_SUB | OP_MUL, base_set({BaseType::REAL}), base_set({BaseType::REAL}), BaseType::REAL},
+    {OP_ADD | OP_SUB | OP_MUL | OP_RDIV, base_set({BaseType::SET}), base_set({BaseType::SET}), BaseType::SET},
+    {OP_IDIV | OP_MOD, INTEGERS, INTEGERS, BaseType::INTEGER},
+    {OP_OR | OP_AND, base_set({BaseType::BOOL}), base_set({BaseType::BOOL}), BaseType::BOOL},
+    {OP_COMPARE, base_set({BaseType::CHAR}), base_set({BaseType::CHAR}), BaseType::BOOL},
+    {OP_COMPARE, INTEGERS, INTEGERS, BaseType::BOOL},
+    {OP_COMPARE, base_set({BaseType::REAL}), base_set({BaseType::REAL}), BaseType::BOOL},
+    {OP_EQ | OP_NEQ, base_set({BaseType::BOOL}), base_set({BaseType::BOOL}), BaseType::BOOL},
+    {OP_EQ | OP_NEQ, base_set({BaseType::SET}), base_set({BaseType::SET}), BaseType::BOOL},
+    {OP_IN, INTEGERS, base_set({BaseType::SET}), BaseType::BOOL},
 };
 
-const std::vector<OpTableLine> optable {
-    {{OP_ADD, OP_SUB, OP_MUL}, {
-            OpTableSubLine{{BaseType::INTEGER, BaseType::BYTE}, {BaseType::INTEGER, BaseType::BYTE}, BaseType::INTEGER},
-            OpTableSubLine{{BaseType::REAL}, {BaseType::REAL}, BaseType::REAL}
-        }},
-    {{OP_ADD, OP_SUB, OP_MUL, OP_RDIV}, {
-            OpTableSubLine{{BaseType::SET}, {BaseType::SET}, BaseType::SET}
-        }},
-    {{OP_IDIV, OP_MOD}, {
-            OpTableSubLine{{BaseType::INTEGER, BaseType::BYTE}, {BaseType::INTEGER, BaseType::BYTE}, BaseType::INTEGER}
-        }},
-    {{OP_OR, OP_AND}, {
-            OpTableSubLine{{BaseType::BOOL}, {BaseType::BOOL}, BaseType::BOOL}
-        }},
-    {{OP_EQ, OP_NEQ, OP_LT, OP_LTE, OP_GT, OP_GTE}, {
-            OpTableSubLine{{BaseType::CHAR}, {BaseType::CHAR}, BaseType::BOOL},
-            OpTableSubLine{{BaseType::INTEGER, BaseType::BYTE}, {BaseType::INTEGER, BaseType::BYTE}, BaseType::BOOL},
-            OpTableSubLine{{BaseType::REAL}, {BaseType::REAL}, BaseType::BOOL}
-        }},
-    {{OP_EQ, OP_NEQ}, {
-            OpTableSubLine{{BaseType::BOOL}, {BaseType::BOOL}, BaseType::BOOL},
-            OpTableSubLine{{BaseType::SET}, {BaseType::SET}, BaseType::BOOL}
-        }},
-    {{OP_IN}, {
-            OpTableSubLine{{BaseType::INTEGER, BaseType::BYTE}, {BaseType::SET}, BaseType::BOOL}
-        }}
-};
+constexpr size_t operator_count = 16;
+constexpr size_t base_type_count = size_t(BaseType::NIL) + 1;
+
+//! Result type by (operator bit, left type, right type); VOID marks a combination without a rule
+using OpTable = std::array<std::array<std::array<BaseType, base_type_count>, base_type_count>, operator_count>;
+
+constexpr OpTable make_optable() {
+    OpTable table{};
+    for (auto& by_left : table)
+        for (auto& by_right : by_left)
+            for (auto& result : by_right) result = BaseType::VOID;
+    for (auto& rule : oprules)
+        for (size_t oper = 0; oper < operator_count; ++oper)
+            if (rule.opers & (1u << oper))
+                for (size_t left = 0; left < base_type_count; ++left)
+                    for (size_t right = 0; right < base_type_count; ++right)
+                        if ((rule.first >> left & 1) && (rule.second >> right & 1) && table[oper][left][right] == BaseType::VOID)
+                            table[oper][left][right] = rule.result;
+    return table;
+}
+
+constexpr OpTable optable = make_optable();
+
+static_assert(optable[std::countr_zero(unsigned(OP_ADD))][size_t(BaseType::BYTE)][size_t(BaseType::INTEGER)] == BaseType::INTEGER);
+static_assert(optable[std::countr_zero(unsigned(OP_RDIV))][size_t(BaseType::INTEGER)][size_t(BaseType::INTEGER)] == BaseType::VOID);
+
+//! Named types are compared through the declaration they resolve to, as Type::same does
+const Type* resolve_name(Context& context, const Type& type) {
+    if (auto name = type.is<TypeName>(); name) {
+        auto resolved = name->dereference(context);
+        return resolved ? resolved->get() : nullptr;
+    }
+    return &type;
+}
+
+bool is_base(const Type* type, BaseType base) {
+    auto builtin = type ? type->is<BuiltInType>() : nullptr;
+    return builtin && builtin->type == base;
+}
+
+//! CHAR or a one-character string constant
+bool is_char_like(const Type* type) {
+    if (is_base(type, BaseType::CHAR)) return true;
+    auto string = type ? type->is<ConstStringType>() : nullptr;
+    return string && string->size == 1;
+}
+
+} // namespace
 
 Maybe<BaseType> nodes::expression_compatible(Context& context, CodePlace place, const Type& left, OpType oper, const Type& right) {
     auto lbase = left.is<BuiltInType>();
     auto rbase = right.is<BuiltInType>();
     if (lbase && rbase) {
-        auto left = lbase->type;
-        auto right = rbase->type;
-        for (auto& line : optable) {
-            bool oper_check = false;
-            for (auto oper_var : line.oper) {
-                if (oper == oper_var) {
-                    oper_check = true;
-                    break;
-                }
-            }
-            if (!oper_check) continue;
-            for (auto subline : line.sublines) {
-                bool left_check = false;
-                for (auto left_var : subline.first) {
-                    if (left == left_var) {
-                        left_check = true;
-                        break;
-                    }
-                }
-                bool right_check = false;
-                for (auto right_var : subline.second) {
-                    if (right == right_var) {
-                        right_check = true;
-                        break;
-                    }
-                }
-                 if (left_check && right_check) return subline.result;
-            }
-        }
+        auto result = optable[std::countr_zero(unsigned(oper))][size_t(lbase->type)][size_t(rbase->type)];
+        if (result != BaseType::VOID) return result;
     }
-    if (oper == OP_EQ || oper == OP_NEQ || oper == OP_LT || oper == OP_LTE || oper == OP_GT || oper == OP_GTE) {
-        if ((left.same(context, BuiltInType(BaseType::CHAR)) || left.same(context, ConstStringType(1)))
-            && (right.same(context, BuiltInType(BaseType::CHAR)) || right.same(context, ConstStringType(1))))
+    if (oper & OP_COMPARE) {
+        auto lresolved = resolve_name(context, left);
+        auto rresolved = resolve_name(context, right);
+        if (is_char_like(lresolved) && is_char_like(rresolved))
             return BaseType::BOOL;
-    }
-    if (oper == OP_EQ || oper == OP_NEQ) {
-        if ((left.same(context, BuiltInType(BaseType::NIL)) || left.is<PointerType>())
-            && (right.same(context, BuiltInType(BaseType::NIL)) || right.is<PointerType>()))
-            return BaseType::BOOL;
-        if ((left.same(context, BuiltInType(BaseType::NIL)) || left.is<ProcedureType>())
-            && (right.same(context, BuiltInType(BaseType::NIL)) || right.is<ProcedureType>()))
-        return BaseType::BOOL;
+        if (oper & (OP_EQ | OP_NEQ)) {
+            auto lnil = is_base(lresolved, BaseType::NIL);
+            auto rnil = is_base(rresolved, BaseType::NIL);
+            if ((lnil || left.is<PointerType>()) && (rnil || right.is<PointerType>()))
+                return BaseType::BOOL;
+            if ((lnil || left.is<ProcedureType>()) && (rnil || right.is<ProcedureType>()))
+                return BaseType::BOOL;
+        }
     }
     if (oper == OP_IS) {
         if (auto rrecord = right.is<RecordType>(); rrecord) {
             auto lrecord = left.is<RecordType>();
-            if (lrecord && rrecord->extends(context, *rrecord)) return BaseType::BOOL;
+            if (lrecord && rrecord->extends(context, *lrecord)) return BaseType::BOOL;
             auto lpointer = left.is<PointerType>();
             if (lpointer) {
                 auto& type = lpointer->get_type(context);
@@ -965,85 +1000,75 @@ Maybe<BaseType> nodes::expression_compatible(Context& context, CodePlace place,
             }
         }
     }
-    context.messages.addErr(place, "Incompatible types for '{}' operator: {} and {}", optype_to_str(oper), left.to_string(), right.to_string());
+    context.messages.addErr(place, "Incompatible types for '{}' operator: {} and {}", optype_to_str(oper), left, right);
     return error;
 }
 
 std::string Term::to_string() const {
-    std::string res = "";
-    if (sign)
-        res += *sign;
-    if (oper)
-        return res + fmt::format("({} {} {})", first, optype_to_str(oper->value), *second);
-    else
-        return res + fmt::format("{}", first);
+    auto res = sign ? fmt::format("{}{}", *sign, first) : fmt::format("{}", first);
+    for (auto& [oper, operand] : operations)
+        res = fmt::format("({} {} {})", res, optype_to_str(oper.value), operand);
+    return res;
 }
 
 Maybe<std::pair<SymbolGroup, TypePtr>> Term::get_type(Context& context) const {
-    if (!oper && !second) {
-        auto res = first->get_type(context);
-        if (!res) return error;
-        auto [group, type] = res.value();
-        if (oper && !type->is<IntegerValue>() && !type->is<RealValue>()) {
+    auto res = first->get_type(context);
+    if (!res) return error;
+    if (is_trivial()) return res;
+    auto type = res->second;
+    if (sign) {
+        auto base = type->is<BuiltInType>();
+        if (!base || !(base->type == BaseType::INTEGER || base->type == BaseType::BYTE
+                       || base->type == BaseType::REAL || base->type == BaseType::SET)) {
             context.messages.addErr(place, "Expected numeric value for sign");
             return error;
         }
-        return res;
-    } else if (oper && second) {
-        auto firstRes = first->get_type(context);
-        if (!firstRes) return error;
-        auto [firstGroup, firstType] = *firstRes;
-        auto secondRes = second.value()->get_type(context);
-        if (!secondRes) return error;
-        auto [secondGroup, secondType] = *secondRes;
-        if (auto type = expression_compatible(context, place, *firstType, oper->value, *secondType); type) {
-            return std::pair(SymbolGroup::CONST, make_type<BuiltInType>(*type));
-        } else {
-            return error;
-        }
-    } else {
-        internal::compiler_error("Invalid term");
     }
+    for (auto& [oper, operand] : operations) {
+        auto operandRes = operand->get_type(context);
+        if (!operandRes) return error;
+        auto result = expression_compatible(context, place, *type, oper.value, *operandRes->second);
+        if (!result) return error;
+        type = make_base_type(*result);
+    }
+    return std::pair(SymbolGroup::CONST, type);
 }
 
 Maybe<ValuePtr> Term::eval_constant(Context& context) const {
-    if (!sign && !oper && !second) {
-        return first->eval_constant(context);
-    } else {
-        auto firstRes = first->eval_constant(context);
-        if (!firstRes) return error;
-        if (sign) {
-            int int_sign = sign == '-' ? -1 : 1;
-            if (auto res_integer = firstRes.value()->is<IntegerValue>(); res_integer) {
-                res_integer->value *= int_sign;
-            } else if (auto res_real = firstRes.value()->is<RealValue>(); res_real) {
-                res_real->value *= int_sign;
-            } else {
-                context.messages.addErr(place, "Expected numeric value for sign");
+    auto res = first->eval_constant(context);
+    if (!res) return error;
+    if (sign) {
+        // The operand may be a shared constant, so the signed value is a new node
+        auto negate = *sign == '-';
+        if (auto integer = res.value()->is<IntegerValue>(); integer) {
+            res = make_value<IntegerValue>(negate ? -integer->value : integer->value);
+        } else if (auto real = res.value()->is<RealValue>(); real) {
+            res = make_value<RealValue>(negate ? -real->value : real->value);
+        } else {
+            context.messages.addErr(place, "Expected numeric value for sign");
+            return error;
+        }
+    }
+    for (auto& [oper, operand] : operations) {
+        auto operandRes = operand->eval_constant(context);
+        if (!operandRes) return error;
+        // Checked here, where the divisor has a place, instead of trapping in IntegerValue::apply_operator
+        auto divisor = operandRes.value()->is<IntegerValue>();
+        if (divisor && (oper.value == OP_IDIV || oper.value == OP_MOD)) {
+            auto dividend = res.value()->is<IntegerValue>();
+            if (divisor->value == 0) {
+                context.messages.addErr(operand->place, "Division by zero");
+                return error;
+            }
+            if (dividend && dividend->value == std::numeric_limits<Integer>::min() && divisor->value == -1) {
+                context.messages.addErr(operand->place, "Integer overflow in {} {} {}", dividend->value,
+                                        optype_to_str(oper.value), divisor->value);
                 return error;
             }
         }
-        if (!second) return firstRes;
-        if (!oper) internal::compiler_error(__FUNCTION__);
-        auto secondRes = second.value()->eval_constant(context);
-        if (!secondRes) return error;
-        return firstRes.value()->apply_operator(context, oper->value, *secondRes.value());
-    }
-}
-
-Term::Term(std::optional<char> s, ExpressionPtr f, std::optional<std::tuple<Operator, ExpressionPtr>> sec)
-    : sign(s), first(f) {
-    if (sec) {
-        auto [op, se] = *sec;
-        oper = op;
-        second = se;
+        res = res.value()->apply_operator(context, oper.value, *operandRes.value());
+        if (!res) return error;
     }
+    return res;
 }
 
-Term::Term(ExpressionPtr f, std::optional<std::tuple<Operator, ExpressionPtr>> sec) : first(f) {
-    if (sec) {
-        auto [op, se] = *sec;
-        oper = op;
-        second = se;
-    }
-}
@@ -0,0 +1,339 @@
+#include "flat_ast.hpp"
+#include "internal_error.hpp"
+
+using namespace nodes;
+
+using Kind = FlatAst::Kind;
+using Index = FlatAst::Index;
+
+class FlatAst::Builder {
+public:
+    explicit Builder(FlatAst& ast) : m_ast(ast) {}
+
+    Index module(const IModule& node) {
+        if (auto module = node.is<Module>(); module) {
+            std::vector<Index> children;
+            declarations(children, module->declarations);
+            children.push_back(sequence(module->body));
+            return add(Kind::Module, module->place, children, ident(module->name));
+        } else if (auto definition = node.is<Definition>(); definition) {
+            std::vector<Index> children;
+            auto& decls = definition->definitions;
+            for (auto& decl : decls.constDecls) children.push_back(const_decl(decl));
+            for (auto& decl : decls.typeDecls) children.push_back(type_decl(decl));
+            for (auto& decl : decls.variableDecls) var_decls(children, decl, Kind::VarDecl);
+            for (auto& decl : decls.procedureDecls) {
+                children.push_back(add(Kind::ProcedureDef, decl.place, {procedure_type(decl.type)},
+                                       ident(decl.name.ident)));
+            }
+            return add(Kind::Definition, definition->place, children, ident(definition->name));
+        }
+        internal::compiler_error("Unexpected module node in FlatAst");
+    }
+
+private:
+    void declarations(std::vector<Index>& children, const DeclarationSequence& decls) {
+        for (auto& decl : decls.constDecls) children.push_back(const_decl(decl));
+        for (auto& decl : decls.typeDecls) children.push_back(type_decl(decl));
+        for (auto& decl : decls.variableDecls) var_decls(children, decl, Kind::VarDecl);
+        for (auto& decl : decls.procedureDecls) children.push_back(procedure(*decl));
+    }
+
+    Index const_decl(const ConstDecl& decl) {
+        auto value = expression(*decl.expression.get_expression());
+        return add(Kind::ConstDecl, decl.ident.ident.place, {value}, ident(decl.ident.ident));
+    }
+
+    Index type_decl(const TypeDecl& decl) {
+        return add(Kind::TypeDecl, decl.ident.ident.place, {type(*decl.type)}, ident(decl.ident.ident));
+    }
+
+    //! One record per declared identifier, each with its own copy of the type subtree
+    void var_decls(std::vector<Index>& children, const FieldList& list, Kind kind) {
+        for (auto& name : list.list) children.push_back(add(kind, name.ident.place, {type(*list.type)}, ident(name.ident)));
+    }
+
+    Index procedure(const Section& section) {
+        auto decl = section.is<ProcedureDeclaration>();
+        if (!decl) internal::compiler_error("Unexpected procedure node in FlatAst");
+        std::vector<Index> children{procedure_type(decl->type)};
+        if (decl->body) {
+            declarations(children, decl->body->decls);
+            children.push_back(sequence(decl->body->statements));
+            if (decl->body->ret) children.push_back(expression(**decl->body->ret));
+        }
+        return add(Kind::ProcedureDecl, decl->place, children, ident(decl->name.ident));
+    }
+
+    Index sequence(const StatementSequence& seq) {
+        std::vector<Index> children;
+        children.reserve(seq.size());
+        for (auto& stat : seq) children.push_back(statement(*stat));
+        return add(Kind::Sequence, seq.empty() ? CodePlace() : seq.front()->place, children);
+    }
+
+    void if_blocks(std::vector<Index>& children, const std::vector<IfBlock>& blocks) {
+        for (auto& [cond, seq] : blocks) {
+            children.push_back(expression(*cond));
+            children.push_back(sequence(seq));
+        }
+    }
+
+    Index statement(const Statement& stat) {
+        std::vector<Index> children;
+        if (auto assign = stat.is<Assignment>(); assign) {
+            children.push_back(designator(assign->variable.unsafe_get(), assign->place));
+            children.push_back(expression(*assign->value));
+            return add(Kind::Assignment, stat.place, children);
+        } else if (auto if_stat = stat.is<IfStatement>(); if_stat) {
+            if_blocks(children, if_stat->if_blocks);
+            if (if_stat->else_block) children.push_back(sequence(*if_stat->else_block));
+            return add(Kind::If, stat.place, children);
+        } else if (auto case_stat = stat.is<CaseStatement>(); case_stat) {
+            children.push_back(expression(*case_stat->expression));
+            for (auto& [labels, seq] : case_stat->cases) {
+                std::vector<Index> branch;
+                for (auto& label : labels) branch.push_back(case_label(label));
+                branch.push_back(sequence(seq));
+                children.push_back(add(Kind::CaseBranch, m_ast.place(branch.front()), branch, Index(labels.size())));
+            }
+            return add(Kind::Case, stat.place, children);
+        } else if (auto while_stat = stat.is<WhileStatement>(); while_stat) {
+            if_blocks(children, while_stat->if_blocks);
+            return add(Kind::While, stat.place, children);
+        } else if (auto repeat = stat.is<RepeatStatement>(); repeat) {
+            auto& [cond, seq] = repeat->if_block;
+            children.push_back(sequence(seq));
+            children.push_back(expression(*cond));
+            return add(Kind::Repeat, stat.place, children);
+        } else if (auto for_stat = stat.is<ForStatement>(); for_stat) {
+            children.push_back(expression(*for_stat->for_expr));
+            children.push_back(expression(*for_stat->to_expr));
+            if (for_stat->by_expr) children.push_back(expression(*for_stat->by_expr->get_expression()));
+            children.push_back(sequence(for_stat->block));
+            return add(Kind::For, stat.place, children, ident(for_stat->ident));
+        } else if (auto call = stat.is<CallStatement>(); call) {
+            return add(Kind::Call, stat.place, {expression(*call->call)});
+        }
+        internal::compiler_error("Unexpected statement node in FlatAst");
+    }
+
+    //! Payload is the number of values, one for a single label and two for a range
+    Index case_label(const CaseLabel& label) {
+        std::vector<Index> children{label_value(label.first, label.place)};
+        if (label.second) children.push_back(label_value(*label.second, label.place));
+        return add(Kind::CaseLabel, label.place, children, Index(children.size()));
+    }
+
+    Index label_value(const Label& label, CodePlace place) {
+        if (auto value = std::get_if<Integer>(&label); value) {
+            m_ast.m_integers.push_back(*value);
+            return add(Kind::Integer, place, {}, Index(m_ast.m_integers.size() - 1));
+        } else if (auto value = std::get_if<StringValue>(&label); value) {
+            return add(Kind::Char, place, {}, Index(static_cast<unsigned char>(value->value.front())));
+        }
+        auto& name = std::get<QualIdent>(label);
+        return add(Kind::TypeName, name.ident.place, {}, qual_ident(name));
+    }
+
+    Index designator(const Designator& desig, CodePlace place) {
+        std::vector<Index> children;
+        for (auto& sel : desig.selector) {
+            if (auto field = std::get_if<Ident>(&sel); field) {
+                children.push_back(add(Kind::Field, field->place, {}, ident(*field)));
+            } else if (auto list = std::get_if<ExpList>(&sel); list) {
+                std::vector<Index> indexes;
+                for (auto& expr : *list) indexes.push_back(expression(*expr));
+                children.push_back(add(Kind::Index, list->empty() ? place : list->front()->place, indexes));
+            } else if (std::holds_alternative<char>(sel)) {
+                children.push_back(add(Kind::Deref, place, {}));
+            } else {
+                auto& guard = std::get<QualIdent>(sel);
+                children.push_back(add(Kind::Guard, guard.ident.place, {}, qual_ident(guard)));
+            }
+        }
+        return add(Kind::Designator, place, children, qual_ident(desig.ident));
+    }
+
+    Index expression(const Expression& expr) {
+        std::vector<Index> children;
+        if (auto value = expr.is<IntegerValue>(); value) {
+            m_ast.m_integers.push_back(value->value);
+            return add(Kind::Integer, expr.place, {}, Index(m_ast.m_integers.size() - 1));
+        } else if (auto value = expr.is<RealValue>(); value) {
+            m_ast.m_reals.push_back(value->value);
+            return add(Kind::Real, expr.place, {}, Index(m_ast.m_reals.size() - 1));
+        } else if (auto value = expr.is<CharValue>(); value) {
+            return add(Kind::Char, expr.place, {}, Index(static_cast<unsigned char>(value->value)));
+        } else if (auto value = expr.is<StringValue>(); value) {
+            m_ast.m_strings.push_back(value->value);
+            return add(Kind::String, expr.place, {}, Index(m_ast.m_strings.size() - 1));
+        } else if (expr.is<NilValue>()) {
+            return add(Kind::Nil, expr.place, {});
+        } else if (auto value = expr.is<BooleanValue>(); value) {
+            return add(Kind::Boolean, expr.place, {}, Index(value->value));
+        } else if (expr.is<SetValue>()) {
+            return add(Kind::SetValue, expr.place, {});
+        } else if (auto builtin = expr.is<BaseProcedureValue>(); builtin) {
+            for (auto& param : builtin->params) children.push_back(expression(*param));
+            return add(Kind::BuiltIn, expr.place, children, Index(builtin->name));
+        } else if (auto set = expr.is<Set>(); set) {
+            for (auto& elem : set->value) {
+                if (elem.second) {
+                    children.push_back(
+                        add(Kind::SetRange, elem.first->place, {expression(*elem.first), expression(**elem.second)}));
+                } else {
+                    children.push_back(expression(*elem.first));
+                }
+            }
+            return add(Kind::Set, expr.place, children);
+        } else if (auto call = expr.is<ProcCall>(); call) {
+            auto& data = call->data.unsafe_get();
+            children.push_back(designator(data.ident.unsafe_get(), expr.place));
+            if (data.params) {
+                for (auto& param : *data.params) children.push_back(expression(*param));
+            }
+            return add(Kind::ProcCall, expr.place, children, Index(data.params.has_value()));
+        } else if (auto tilda = expr.is<Tilda>(); tilda) {
+            return add(Kind::Tilda, expr.place, {expression(*tilda->expression)});
+        } else if (auto term = expr.is<Term>(); term) {
+            children.push_back(expression(*term->first));
+            for (auto& operation : term->operations) children.push_back(expression(*operation.operand));
+            auto first = Index(m_ast.m_operators.size());
+            m_ast.m_operators.push_back(!term->sign ? OpType(0) : *term->sign == '-' ? OP_SUB : OP_ADD);
+            for (auto& operation : term->operations) m_ast.m_operators.push_back(operation.oper.value);
+            return add(Kind::Term, expr.place, children, first);
+        }
+        internal::compiler_error("Unexpected expression node in FlatAst");
+    }
+
+    Index procedure_type(const ProcedureType& proc) {
+        std::vector<Index> children;
+        auto parameter = [&](const FormalParameter& param) {
+            children.push_back(add(param.var ? Kind::VarParameter : Kind::Parameter, param.ident.place,
+                                   {type(*param.type)}, ident(param.ident)));
+        };
+        for (auto& param : proc.params.common) parameter(param);
+        for (auto& param : proc.params.formal) parameter(param);
+        if (proc.params.rettype) children.push_back(type(**proc.params.rettype));
+        return add(Kind::ProcedureType, proc.place, children, Index(proc.params.common.size()));
+    }
+
+    Index type(const Type& node) {
+        std::vector<Index> children;
+        if (auto builtin = node.is<BuiltInType>(); builtin) {
+            return add(Kind::BuiltInType, node.place, {}, Index(builtin->type));
+        } else if (auto name = node.is<TypeName>(); name) {
+            return add(Kind::TypeName, node.place, {}, qual_ident(name->ident));
+        } else if (auto name = node.is<ImportTypeName>(); name) {
+            return add(Kind::ImportTypeName, node.place, {}, qual_ident(name->ident));
+        } else if (auto record = node.is<RecordType>(); record) {
+            for (auto& list : record->seq) var_decls(children, list, Kind::VarDecl);
+            return add(Kind::RecordType, node.place, children,
+                       record->basetype ? qual_ident(*record->basetype) : no_payload);
+        } else if (auto pointer = node.is<PointerType>(); pointer) {
+            return add(Kind::PointerType, node.place, {type(*pointer->type)});
+        } else if (auto str = node.is<ConstStringType>(); str) {
+            return add(Kind::ConstStringType, node.place, {}, Index(str->size));
+        } else if (auto array = node.is<ArrayType>(); array) {
+            if (!array->open_array) children.push_back(expression(*array->length.get_expression()));
+            children.push_back(type(*array->type));
+            return add(Kind::ArrayType, node.place, children, Index(array->open_array));
+        } else if (auto proc = node.is<ProcedureType>(); proc) {
+            return procedure_type(*proc);
+        } else if (auto common = node.is<CommonType>(); common) {
+            for (auto& pair : common->pair_list) children.push_back(type(*pair.type));
+            if (common->else_clause) children.push_back(type(**common->else_clause));
+            return add(Kind::CommonType, node.place, children, Index(common->pair_list.size()));
+        } else if (auto scalar = node.is<ScalarType>(); scalar) {
+            return add(Kind::ScalarType, node.place, {type(*scalar->type)});
+        }
+        internal::compiler_error("Unexpected type node in FlatAst");
+    }
+
+    Index ident(const Ident& name) {
+        m_ast.m_idents.push_back(name);
+        return Index(m_ast.m_idents.size() - 1);
+    }
+
+    Index qual_ident(const QualIdent& name) {
+        if (!name.qual) return ident(name.ident);
+        Ident full = *name.qual;
+        full.value.push_back('.');
+        full.value.insert(full.value.end(), name.ident.value.begin(), name.ident.value.end());
+        full.place = name.ident.place;
+        return ident(full);
+    }
+
+    Index add(Kind kind, CodePlace place, std::span<const Index> children, Index payload = no_payload) {
+        Index first = Index(m_ast.m_children.size());
+        m_ast.m_children.insert(m_ast.m_children.end(), children.begin(), children.end());
+        m_ast.m_records.push_back(Record{kind, Index(place.get_index()), first, Index(children.size()), payload});
+        return Index(m_ast.m_records.size() - 1);
+    }
+
+    Index add(Kind kind, CodePlace place, std::initializer_list<Index> children, Index payload = no_payload) {
+        return add(kind, place, std::span<const Index>(children.begin(), children.size()), payload);
+    }
+
+    FlatAst& m_ast;
+};
+
+FlatAst FlatAst::build(const IModule& module) {
+    FlatAst ast;
+    Builder(ast).module(module);
+    return ast;
+}
+
+const char* FlatAst::kind_to_str(Kind kind) {
+    switch (kind) {
+        case Kind::Module: return "Module";
+        case Kind::Definition: return "Definition";
+        case Kind::ConstDecl: return "ConstDecl";
+        case Kind::TypeDecl: return "TypeDecl";
+        case Kind::VarDecl: return "VarDecl";
+        case Kind::ProcedureDecl: return "ProcedureDeclaration";
+        case Kind::ProcedureDef: return "ProcedureDefinition";
+        case Kind::Sequence: return "StatementSequence";
+        case Kind::Assignment: return "Assignment";
+        case Kind::If: return "IfStatement";
+        case Kind::Case: return "CaseStatement";
+        case Kind::CaseBranch: return "Case";
+        case Kind::CaseLabel: return "CaseLabel";
+        case Kind::While: return "WhileStatement";
+        case Kind::Repeat: return "RepeatStatement";
+        case Kind::For: return "ForStatement";
+        case Kind::Call: return "CallStatement";
+        case Kind::Integer: return "IntegerValue";
+        case Kind::Real: return "RealValue";
+        case Kind::Char: return "CharValue";
+        case Kind::String: return "StringValue";
+        case Kind::Nil: return "NilValue";
+        case Kind::Boolean: return "BooleanValue";
+        case Kind::SetValue: return "SetValue";
+        case Kind::BuiltIn: return "BaseProcedureValue";
+        case Kind::Set: return "Set";
+        case Kind::SetRange: return "SetElement";
+        case Kind::ProcCall: return "ProcCall";
+        case Kind::Designator: return "Designator";
+        case Kind::Field: return "FieldSelector";
+        case Kind::Index: return "IndexSelector";
+        case Kind::Deref: return "DerefSelector";
+        case Kind::Guard: return "TypeGuard";
+        case Kind::Tilda: return "Tilda";
+        case Kind::Term: return "Term";
+        case Kind::BuiltInType: return "BuiltInType";
+        case Kind::TypeName: return "TypeName";
+        case Kind::ImportTypeName: return "ImportTypeName";
+        case Kind::RecordType: return "RecordType";
+        case Kind::PointerType: return "PointerType";
+        case Kind::ConstStringType: return "ConstStringType";
+        case Kind::ArrayType: return "ArrayType";
+        case Kind::ProcedureType: return "ProcedureType";
+        case Kind::Parameter: return "FormalParameter";
+        case Kind::VarParameter: return "VarParameter";
+        case Kind::CommonType: return "CommonType";
+        case Kind::ScalarType: return "ScalarType";
+        default: internal::compiler_error("Unexpected FlatAst kind");
+    }
+}
@@ -1,35 +1,113 @@
 #include "module_loader.hpp"
+#include "ast_stats.hpp"
+#include "constant_folding.hpp"
 #include "libparser/format.hpp"
+#include "libparser/profiler.hpp"
+#include "multimethod_table.hpp"
+#include "time_report.hpp"
 #include <iostream>
 
 inline void writeHelp(std::ostream& stream) {
-    stream << "Usage: oberon INFILE [OUTFILE]" << std::endl << "With no OUTFILE write to standard output" << std::endl;
+    stream << "Usage: oberon [OPTIONS] INFILE [OUTFILE]" << std::endl
+           << "With no OUTFILE write to standard output" << std::endl
+           << "Options:" << std::endl
+           << "  -h, --help            Show this message" << std::endl
+           << "  -ftime-report         Print time spent in each compilation phase" << std::endl
+           << "  -ftime-trace=FILE     Write phase timings to FILE in Chrome trace event format" << std::endl
+           << "  -freorder-fields      Reorder record fields by alignment to reduce padding" << std::endl
+           << "  --dump-dispatch       Print the dispatch table of every multimethod" << std::endl
+           << "  --dump-folding        Print the branches removed by constant folding" << std::endl
+           << "  --dump-layout         Print size, alignment and field offsets of declared records and arrays" << std::endl
+           << "  --parser-profile      Print per grammar rule parser statistics" << std::endl
+           << "  --stats               Print allocations per compilation phase, AST node counts and multimethod call bindings" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
     std::string_view programName{argv[0]};
     std::vector<std::string_view> args;
+    std::string_view trace_file;
+    bool time_report = false;
+    bool parser_profile = false;
+    bool stats = false;
+    bool dump_dispatch = false;
+    bool dump_folding = false;
+    bool dump_layout = false;
+    bool reorder_fields = false;
     for (int i = 1; i < argc; i++) {
-        args.push_back(argv[i]);
+        std::string_view arg{argv[i]};
+        if (arg == "-h" || arg == "--help") {
+            writeHelp(std::cout);
+            return 0;
+        } else if (arg == "-ftime-report") {
+            time_report = true;
+        } else if (arg == "-freorder-fields") {
+            reorder_fields = true;
+        } else if (arg == "--dump-dispatch") {
+            dump_dispatch = true;
+        } else if (arg == "--dump-folding") {
+            dump_folding = true;
+        } else if (arg == "--dump-layout") {
+            dump_layout = true;
+        } else if (arg == "--parser-profile") {
+            parser_profile = true;
+        } else if (arg == "--stats") {
+            stats = true;
+        } else if (arg.starts_with("-ftime-trace=")) {
+            trace_file = arg.substr(std::string_view("-ftime-trace=").size());
+        } else if (arg.starts_with("-")) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            writeHelp(std::cerr);
+            return 1;
+        } else {
+            args.push_back(arg);
+        }
     }
 
-    if (args.size() < 1 || args.size() > 1) {
+    if (args.size() != 1) {
         writeHelp(std::cout);
         return 1;
-    } else if (args[0] == "-h" || args[0] == "--help") {
-        writeHelp(std::cout);
-        return 0;
     }
 
+    if (time_report || stats || !trace_file.empty())
+        TimeReport::instance().enable(!trace_file.empty());
+    if (stats)
+        AstStats::enable();
+    if (parser_profile)
+        ParserProfiler::enable();
+    if (dump_dispatch)
+        MultimethodTable::enable_dump();
+    if (dump_folding)
+        ConstantFolder::enable_dump();
+    if (dump_layout)
+        TypeInterner::enable_dump();
+
     auto parser = get_parsers();
     IOManager io;
     ModuleLoader loader(parser);
-    auto res = loader.load(io, args[0].data());
+    loader.set_field_reordering(reorder_fields);
+    auto res = [&] {
+        PhaseTimer timer("compile");
+        return loader.load(io, args[0].data());
+    }();
     if (res) {
+        PhaseTimer timer("output");
         fmt::print("{}", res->to_string());
     }
     if (!res)
         fmt::print(format_red("Exit with error\n"));
 
+    if (parser_profile)
+        ParserProfiler::instance().print(std::cerr);
+    if (time_report)
+        TimeReport::instance().print(std::cerr);
+    if (stats) {
+        TimeReport::instance().print_memory(std::cerr);
+        AstStats::instance().print(std::cerr);
+        auto [allocations, bytes] = loader.arena_usage();
+        std::cerr << fmt::format("Module arenas: {} allocations, {:.1f} KB\n", allocations, bytes / 1024.0);
+    }
+    if (!trace_file.empty() && !TimeReport::instance().write_trace(std::string(trace_file)))
+        io.log("IO", fmt::format("Can't write trace file '{}'", trace_file));
+
     return 0;
 }
@@ -16,11 +16,15 @@ std::string format_error(const char* text, int color, CodeStream& code, CodePlac
 }
 
 void MessageContainer::addMessage(Message message) {
+    if (muted()) return;
     const char* text;
     int color;
     if (message.priority == MPriority::ERR) {
         text = "Error";
         color = Red;
+    } else if (message.priority == MPriority::NOTE) {
+        text = "Note";
+        color = Blue;
     } else {
         text = "Warning";
         color = Yellow;
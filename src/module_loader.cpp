@@ -1,16 +1,19 @@
 #include "module_loader.hpp"
+#include "ast_stats.hpp"
+#include "flat_ast.hpp"
 #include "internal_error.hpp"
 #include "module_table.hpp"
 #include "section_nodes.hpp"
 #include "semantic_context.hpp"
+#include "time_report.hpp"
 
 std::unique_ptr<ModuleTableI> load_module(std::shared_ptr<nodes::IModule> module, std::vector<std::pair<nodes::Import, ModuleTablePtr>> imports, MessageContainer& messages) {
     auto module_ptr = module.get();
-    if (auto module = dynamic_cast<nodes::Module*>(module_ptr); module) {
+    if (auto module = nodes::dyn_cast<nodes::Module>(module_ptr); module) {
         auto modRes = ModuleTable::parse(*module, imports, messages);
         if (!modRes) return {};
         return std::unique_ptr<ModuleTableI>(modRes.release());
-    } else if (auto definition = dynamic_cast<nodes::Definition*>(module_ptr); definition) {
+    } else if (auto definition = nodes::dyn_cast<nodes::Definition>(module_ptr); definition) {
         auto defRes = ModuleTable::parse(*definition, imports, messages);
         if (!defRes) return {};
         return std::unique_ptr<ModuleTableI>(defRes.release());
@@ -19,50 +22,78 @@ std::unique_ptr<ModuleTableI> load_module(std::shared_ptr<nodes::IModule> module
 }
 
 ModuleTableI* ModuleLoader::load(IOManager& io, std::string module_name) {
-    auto res = io.get_code_file(module_name);
+    PhaseTimer module_timer("module {}", module_name);
+    auto res = [&] {
+        PhaseTimer timer("file load");
+        return io.get_code_file(module_name);
+    }();
     if (!res) return nullptr;
     auto [code, messages] = *res;
-    std::chrono::time_point<std::chrono::steady_clock> start, end;
-    std::chrono::milliseconds parse_duration;
-    start = std::chrono::steady_clock::now();
-    auto code_iterator = code->get_iterator();
-    auto parseResult = parser->parse(code_iterator);
-    end = std::chrono::steady_clock::now();
-    parse_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    io.log("Time", fmt::format("Module {} parse time: {}ms", module_name, parse_duration.count()));
+    arenas.push_back(std::make_unique<Arena>());
+    ArenaScope arena_scope(*arenas.back());
+    TypeInterner::Scope interner_scope(interner);
+    auto code_iterator = code->get_iterator(arenas.back().get());
+    auto parseResult = [&] {
+        PhaseTimer timer("parse");
+        return parser->parse(code_iterator);
+    }();
     if (!parseResult) {
         messages.addErr(code_iterator.place(), code_iterator.format_error().c_str());
         return nullptr;
     }
     auto moduleTree = parseResult.value();
+    // The flat encoding is only used to count nodes, so it is built and dropped only with --stats
+    if (AstStats::enabled()) {
+        PhaseTimer timer("flatten");
+        AstStats::instance().count(FlatAst::build(*moduleTree));
+    }
     auto import_error = false;
     std::vector<std::pair<nodes::Import, ModuleTablePtr>> imports;
-    for (auto& import : moduleTree->get_imports()) {
-        if (auto unitRes = units.find(import.real_name); unitRes != units.end()) {
-            if (unitRes->second.get() == nullptr) {
-                messages.addErr(import.name.place, "Can't analyze module {} because of error in module {}", moduleTree->get_name(), import.real_name);
-                import_error = true;
+    {
+        PhaseTimer timer("imports");
+        for (auto& import : moduleTree->get_imports()) {
+            if (auto unitRes = units.find(import.real_name); unitRes != units.end()) {
+                if (unitRes->second.get() == nullptr) {
+                    messages.addErr(import.name.place, "Can't analyze module {} because of error in module {}", moduleTree->get_name(), import.real_name);
+                    import_error = true;
+                } else {
+                    std::pair pair(import, static_cast<const ModuleTableI*>(unitRes->second.get()));
+                    imports.push_back(pair);
+                }
             } else {
-                std::pair pair(import, static_cast<const ModuleTableI*>(unitRes->second.get()));
-                imports.push_back(pair);
+                 auto res = load(io, import.real_name.to_string());
+                 if (!res) {
+                     units[import.real_name] = std::unique_ptr<ModuleTableI>(nullptr);
+                     import_error = true;
+                 } else {
+                     std::pair pair(import, static_cast<const ModuleTableI*>(res));
+                     imports.push_back(pair);
+                 }
             }
-        } else {
-             auto res = load(io, import.real_name.to_string());
-             if (!res) {
-                 units[import.real_name] = std::unique_ptr<ModuleTableI>(nullptr);
-                 import_error = true;
-             } else {
-                 std::pair pair(import, static_cast<const ModuleTableI*>(res));
-                 imports.push_back(pair);
-             }
         }
     }
     if (import_error) return nullptr;
-    auto moduleRes = load_module(moduleTree, imports, messages);
+    auto moduleRes = [&] {
+        PhaseTimer timer("symbols");
+        return load_module(moduleTree, imports, messages);
+    }();
     if (!moduleRes.get()) return nullptr;
 
-    if (!moduleRes->analyze_code(messages)) return nullptr;
+    {
+        PhaseTimer timer("analyze");
+        if (!moduleRes->analyze_code(messages)) return nullptr;
+    }
+    moduleRes->build_export_view();
 
     units[moduleTree->get_name()] = std::move(moduleRes);
     return units[moduleTree->get_name()].get();
 }
+
+std::pair<size_t, size_t> ModuleLoader::arena_usage() const {
+    std::pair<size_t, size_t> usage;
+    for (auto& arena : arenas) {
+        usage.first += arena->allocations();
+        usage.second += arena->bytes();
+    }
+    return usage;
+}
@@ -51,24 +51,28 @@ bool ModuleTable::add_import(MessageContainer& messages, nodes::Import import, M
     return bsuccess;
 }
 
-Maybe<SymbolToken> ModuleTable::get_symbol_out(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const {
-    if (m_exports.contains(ident.ident)) {
-        nodes::QualIdent name{{}, ident.ident};
-        auto res = symbols.get_symbol(messages, name, secretly);
-        if (res) {
-            auto symbol = *res;
-            symbol.group = SymbolGroup::CONST;
-            return symbol;
-        } else {
-            messages.addErr(ident.ident.place, "Symbol {} not found", ident);
-            return error;
-        }
-    } else {
-        messages.addErr(ident.ident.place, "Attempting to access a non-exported symbol {}", ident);
-        return error;
+void ModuleTable::build_export_view() {
+    m_export_view.reserve(m_exports.size());
+    for (auto& name : m_exports) {
+        auto entry = symbols.find(name);
+        if (!entry) continue;
+        auto symbol = entry->symbol;
+        symbol.group = SymbolGroup::CONST;
+        m_export_view.emplace(name, SymbolEntry{std::move(symbol), entry->value, nullptr});
     }
 }
 
+const SymbolEntry* ModuleTable::find_export(const nodes::Ident& ident) const {
+    auto res = m_export_view.find(ident);
+    return res == m_export_view.end() ? nullptr : &res->second;
+}
+
+Maybe<SymbolToken> ModuleTable::get_symbol_out(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const {
+    if (auto entry = find_export(ident.ident); entry) return entry->symbol;
+    if (!secretly) messages.addErr(ident.ident.place, "Attempting to access a non-exported symbol {}", ident);
+    return error;
+}
+
 Maybe<SymbolToken> ModuleTable::get_symbol(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const {
     if (!ident.qual) {
         return symbols.get_symbol(messages, ident, secretly);
@@ -76,13 +80,13 @@ Maybe<SymbolToken> ModuleTable::get_symbol(MessageContainer& messages, const nod
         if (auto res = m_imports.find(*ident.qual); res != m_imports.end()) {
             auto& import = res->second;
             if (import.module == nullptr) {
-                messages.addErr(ident.qual->place, "Module {} not found", import.name);
+                if (!secretly) messages.addErr(ident.qual->place, "Module {} not found", import.name);
                 return error;
             } else {
                 return import.module->get_symbol_out(messages, ident, secretly);
             }
         } else {
-            messages.addErr(ident.qual->place, "Import '{}' does not exist", *ident.qual);
+            if (!secretly) messages.addErr(ident.qual->place, "Import '{}' does not exist", *ident.qual);
             return error;
         }
     }
@@ -93,10 +97,13 @@ Maybe<nodes::ValuePtr> ModuleTable::get_value(MessageContainer& messages, const
         return symbols.get_value(messages, ident, secretly);
     } else {
         if (auto res = m_imports.find(*ident.qual); res != m_imports.end()) {
-            messages.addErr(ident.ident.place, "Attempting to access outer value {}", ident);
+            // Constants of an imported module are in its export view, other exported names have no value
+            if (auto module = res->second.module; module)
+                if (auto entry = module->find_export(ident.ident); entry && entry->value) return entry->value;
+            if (!secretly) messages.addErr(ident.ident.place, "Attempting to access outer value {}", ident);
             return error;
         } else {
-            messages.addErr(m_name.place, "Import '{}' does not exist", res->second.name);
+            if (!secretly) messages.addErr(ident.qual->place, "Import '{}' does not exist", *ident.qual);
             return error;
         }
     }
@@ -106,11 +113,11 @@ Maybe<TablePtr> ModuleTable::get_table(MessageContainer& messages, const nodes::
     if (!ident.qual) {
         return symbols.get_table(messages, ident, secretly);
     } else {
-        if (auto res = m_imports.find(*ident.qual); res != m_imports.end()) {
-            messages.addErr(ident.ident.place, "Attempting to access outer value {}", ident);
+        if (m_imports.contains(*ident.qual)) {
+            if (!secretly) messages.addErr(ident.ident.place, "Attempting to access outer value {}", ident);
             return error;
         } else {
-            messages.addErr(m_name.place, "Import '{}' does not exist", res->second.name);
+            if (!secretly) messages.addErr(ident.qual->place, "Import '{}' does not exist", *ident.qual);
             return error;
         }
     }
@@ -1,9 +1,11 @@
 #include "multimethod_table.hpp"
 #include "message_container.hpp"
+#include "node_formatters.hpp"
 #include "semantic_context.hpp"
 #include "symbol_container.hpp"
 #include "symbol_table.hpp"
 #include "type_nodes.hpp"
+#include <algorithm>
 #include <ranges>
 
 std::unique_ptr<MultimethodTable> MultimethodTable::parse(const nodes::ProcedureDeclaration& proc, const SymbolTable* parent,
@@ -16,6 +18,15 @@ std::unique_ptr<MultimethodTable> MultimethodTable::parse(const nodes::Procedure
     table->m_type = proc.type;
     auto success = parseProcedureType(messages, *table, proc);
     if (!success) return nullptr;
+    size_t combinations = 1;
+    for (auto& param : table->m_type.params.common) {
+        auto common = param.type->is<nodes::CommonType>();
+        if (!common) internal::compiler_error("Multimethod parameter is not a common type");
+        table->m_axes.push_back(common);
+        table->m_dispatch.extents.push_back(common->pair_list.size());
+        combinations *= common->pair_list.size();
+    }
+    table->m_dispatch.table.assign(combinations, MultimethodDispatch::no_instance);
     return table;
 }
 
@@ -38,11 +49,11 @@ bool MultimethodTable::instance_compatible(MessageContainer& messages, bool with
             if (auto scalar_type = instIt->type->is<nodes::ScalarType>(); scalar_type) {
                 auto res = multiIt->type->same(context, *scalar_type->type);
                 if (!res) {
-                    if (with_messages) messages.addErr(instance->m_name.place, "Expected same common type, found: {}", instIt->type->to_string());
+                    if (with_messages) messages.addErr(instance->m_name.place, "Expected same common type, found: {}", *instIt->type);
                     return false;
                 }
             } else {
-                if (with_messages) messages.addErr(instance->m_name.place, "Expected scalar type, found: {}", instIt->type->to_string());
+                if (with_messages) messages.addErr(instance->m_name.place, "Expected scalar type, found: {}", *instIt->type);
                 return false;
             }
         }
@@ -64,15 +75,65 @@ bool MultimethodTable::can_overload(MessageContainer& messages, const ProcedureT
 }
 
 bool MultimethodTable::overload(MessageContainer& messages, std::shared_ptr<ProcedureTable> table) {
-    if (instance_compatible(messages, true, *table)) {
-        m_instances.push_back(std::static_pointer_cast<MultimethodInstanceTable>(table));
-        return true;
+    if (!instance_compatible(messages, true, *table)) return false;
+    auto instance = std::static_pointer_cast<MultimethodInstanceTable>(table);
+    std::vector<size_t> cases;
+    for (size_t i = 0; i < m_axes.size(); i++) {
+        auto& scalar = *instance->m_type.params.common[i].type->is<nodes::ScalarType>();
+        auto index = case_index(i, scalar.feature);
+        if (!index) internal::compiler_error("Multimethod instance case not found in common type");
+        cases.push_back(*index);
     }
-    return false;
+    auto& slot = m_dispatch.table[m_dispatch.offset(cases)];
+    if (slot != MultimethodDispatch::no_instance) {
+        messages.addErr(instance->m_name.place, "Ambiguous multimethod instance: {} already has an instance for the same cases",
+                        m_name);
+        return false;
+    }
+    slot = std::int32_t(m_instances.size());
+    m_instances.push_back(instance);
+    return true;
+}
+
+std::optional<size_t> MultimethodTable::case_index(size_t param, const nodes::CommonFeature& feature) const {
+    auto& cases = m_axes[param]->pair_list;
+    auto it = std::ranges::find(cases, feature, &nodes::CommonPair::feature);
+    if (it == cases.end()) return std::nullopt;
+    return size_t(it - cases.begin());
+}
+
+const MultimethodInstanceTable* MultimethodTable::instance_for(std::span<const size_t> cases) const {
+    auto slot = m_dispatch.table[m_dispatch.offset(cases)];
+    return slot == MultimethodDispatch::no_instance ? nullptr : m_instances[slot].get();
+}
+
+void MultimethodTable::report_missing_instances(MessageContainer& messages) const {
+    auto missing = std::ranges::find(m_dispatch.table, MultimethodDispatch::no_instance);
+    if (missing == m_dispatch.table.end()) return;
+    // Decode the first missing combination from its row-major offset
+    auto offset = size_t(missing - m_dispatch.table.begin());
+    std::vector<std::string> features(m_axes.size());
+    for (size_t i = m_axes.size(); i-- > 0;) {
+        features[i] = fmt::format("{}", m_axes[i]->pair_list[offset % m_dispatch.extents[i]].feature);
+        offset /= m_dispatch.extents[i];
+    }
+    auto count = std::ranges::count(m_dispatch.table, MultimethodDispatch::no_instance);
+    messages.addFormat(MPriority::W2, m_name.place, "Multimethod {} has no instance for {} of {} case combinations, such as <{}>",
+                       m_name, count, m_dispatch.table.size(), fmt::format("{}", fmt::join(features, ", ")));
+}
+
+void MultimethodTable::dump_dispatch(MessageContainer& messages) const {
+    std::vector<std::string> entries;
+    for (auto slot : m_dispatch.table)
+        entries.push_back(slot == MultimethodDispatch::no_instance ? "base" : std::to_string(slot));
+    messages.addFormat(MPriority::NOTE, m_name.place, "Dispatch table of {}: extents {}; entries {}", m_name,
+                       fmt::format("{}", fmt::join(m_dispatch.extents, " x ")), fmt::format("{}", fmt::join(entries, ", ")));
 }
 
 bool MultimethodTable::analyze_code(MessageContainer& messages) const {
     auto context = nodes::Context(messages, *this);
+    report_missing_instances(messages);
+    if (s_dump_dispatch) dump_dispatch(messages);
     bool success = get_symbols().analyze_code(context);
     for (auto instance : m_instances) {
         if (!instance->analyze_code(messages)) success = false;
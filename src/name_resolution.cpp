@@ -0,0 +1,90 @@
+#include "name_resolution.hpp"
+#include "expression_nodes.hpp"
+#include "node_formatters.hpp"
+#include "statement_nodes.hpp"
+#include "symbol_table.hpp"
+
+using namespace nodes;
+
+namespace {
+
+class NameResolver {
+public:
+    explicit NameResolver(const SymbolTable& scope) : m_scope(scope) {}
+
+    void sequence(const StatementSequence& seq) {
+        for (auto& statement : seq) this->statement(*statement);
+    }
+
+private:
+    void statement(const Statement& stat) {
+        if (auto assign = stat.is<Assignment>(); assign) {
+            designator(assign->variable.unsafe_get());
+            expression(*assign->value);
+        } else if (auto if_stat = stat.is<IfStatement>(); if_stat) {
+            if_blocks(if_stat->if_blocks);
+            if (if_stat->else_block) sequence(*if_stat->else_block);
+        } else if (auto case_stat = stat.is<CaseStatement>(); case_stat) {
+            expression(*case_stat->expression);
+            for (auto& [labels, seq] : case_stat->cases) sequence(seq);
+        } else if (auto while_stat = stat.is<WhileStatement>(); while_stat) {
+            if_blocks(while_stat->if_blocks);
+        } else if (auto repeat = stat.is<RepeatStatement>(); repeat) {
+            auto& [cond, seq] = repeat->if_block;
+            sequence(seq);
+            expression(*cond);
+        } else if (auto for_stat = stat.is<ForStatement>(); for_stat) {
+            expression(*for_stat->for_expr);
+            expression(*for_stat->to_expr);
+            sequence(for_stat->block);
+        } else if (auto call = stat.is<CallStatement>(); call) {
+            expression(*call->call);
+        }
+    }
+
+    void if_blocks(const std::vector<IfBlock>& blocks) {
+        for (auto& [cond, seq] : blocks) {
+            expression(*cond);
+            sequence(seq);
+        }
+    }
+
+    void designator(const Designator& desig) {
+        desig.bind(m_scope);
+        for (auto& sel : desig.selector) {
+            if (auto list = std::get_if<ExpList>(&sel); list) {
+                for (auto& expr : *list) expression(*expr);
+            }
+        }
+    }
+
+    void expression(const Expression& expr) {
+        if (auto call = expr.is<ProcCall>(); call) {
+            auto& data = call->data.unsafe_get();
+            designator(data.ident.unsafe_get());
+            if (data.params) {
+                for (auto& param : *data.params) expression(*param);
+            }
+        } else if (auto builtin = expr.is<BaseProcedureValue>(); builtin) {
+            for (auto& param : builtin->params) expression(*param);
+        } else if (auto set = expr.is<Set>(); set) {
+            for (auto& [first, last] : set->value) {
+                expression(*first);
+                if (last) expression(**last);
+            }
+        } else if (auto tilda = expr.is<Tilda>(); tilda) {
+            expression(*tilda->expression);
+        } else if (auto term = expr.is<Term>(); term) {
+            expression(*term->first);
+            for (auto& operation : term->operations) expression(*operation.operand);
+        }
+    }
+
+    const SymbolTable& m_scope;
+};
+
+} // namespace
+
+void resolve_names(const SymbolTable& scope, const StatementSequence& body) {
+    NameResolver(scope).sequence(body);
+}
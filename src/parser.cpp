@@ -4,7 +4,9 @@
 #include "libparser/code_iterator.hpp"
 #include "libparser/parser.hpp"
 #include "libparser/parsers.hpp"
+#include "libparser/profiler.hpp"
 #include "section_nodes.hpp"
+#include <algorithm>
 #include <string_view>
 
 using namespace nodes;
@@ -106,7 +108,7 @@ public:
     }
 };
 
-auto delim = make_parser(Delim());
+auto delim = named(make_parser(Delim()), "delim");
 
 template <class T, class D>
 ParserPtr<std::vector<T>> extra_delim(ParserPtr<T> parser, ParserPtr<D> extra) {
@@ -223,8 +225,8 @@ ParserPtr<char> letter = predicate("letter", [](auto c) { return (c >= 'A' && c
 ParserPtr<char> digit = predicate("digit", isdigit);
 ParserPtr<char> hexdigit = predicate("hexdigit", isxdigit);
 ParserPtr<char> letter_or_digit = predicate("latter or digit", is_letter_or_digit);
-ParserPtr<Ident> identifier = set_place(construct<Ident>(chain(letter, many(letter_or_digit))));
-ParserPtr<Ident> ident = not_from(identifier, keywords);
+ParserPtr<Ident> identifier = named(set_place(construct<Ident>(chain(letter, many(letter_or_digit)))), "identifier");
+ParserPtr<Ident> ident = named(not_from(identifier, keywords), "ident");
 
 ParserPtr<Ident> keyword(std::string_view key) {
     std::vector<char> val({});
@@ -233,7 +235,7 @@ ParserPtr<Ident> keyword(std::string_view key) {
 }
 
 ParserPtr<QualIdent> qualident =
-    construct<QualIdent>(sequence(maybe(parse_index<0>::select(ident, symbol('.'))), ident));
+    named(construct<QualIdent>(sequence(maybe(parse_index<0>::select(ident, symbol('.'))), ident)), "qualident");
 
 ParserPtr<IdentDef> identdef = extension(sequence(ident, maybe(symbol('*'))), [](const auto& pair) {
     auto [ident, def] = pair;
@@ -294,10 +296,10 @@ auto type_parser(ParserPtr<ExpressionPtr> expression, ParserPtr<CommonFeature> c
         construct<FPSection>(syntax_sequence(option(keyword("VAR")), extra_delim(ident, symbol(',')),
                                              syntax_index<1>::select(symbol(':'), either({scalarType, typeName}))));
 
-    auto formalParameters = construct<FormalParameters>(syntax_sequence(
+    auto formalParameters = named(construct<FormalParameters>(syntax_sequence(
         maybe(syntax_index<1>::select(symbol('{'), extra_delim(commonFPSection, symbol(';')), symbol('}'))),
         maybe(syntax_index<1>::select(symbol('('), maybe_list(extra_delim(fpSection, symbol(';'))), symbol(')'))),
-        maybe(syntax_index<1>::select(symbol(':'), typeName))));
+        maybe(syntax_index<1>::select(symbol(':'), typeName)))), "formal parameters");
 
     auto procedureType =
         construct<ProcedureType>(syntax_index<1>::select(keyword("PROCEDURE"), maybe(formalParameters)));
@@ -311,9 +313,11 @@ auto type_parser(ParserPtr<ExpressionPtr> expression, ParserPtr<CommonFeature> c
         keyword("CASE"), maybe(commonFeatureType), keyword("OF"), extra_delim(commonPair, symbols("|")),
         maybe(syntax_index<1>::select(keyword("ELSE"), typeName)), keyword(("END"))));
 
-    ParserPtr<TypePtr> strucType = node_either<Type>(recordType, pointerType, arrayType, procedureType, commonType);
+    ParserPtr<TypePtr> strucType = node_either<Type>(named(recordType, "record type"), named(pointerType, "pointer type"),
+                                                     named(arrayType, "array type"), named(procedureType, "procedure type"),
+                                                     named(commonType, "common type"));
 
-    auto realType = typeLink.link(either({strucType, typeName}));
+    auto realType = typeLink.link(named(either({strucType, typeName}), "type"));
 
     return std::tuple{realType, formalParameters, fieldList};
 }
@@ -353,7 +357,7 @@ auto expression_parser() {
     });
 
     ParserPtr<Integer> integer =
-        construct<Integer>(either({parse_index<0>::select(hexnumber, symbol('H')), decnumber}));
+        named(construct<Integer>(either({parse_index<0>::select(hexnumber, symbol('H')), decnumber})), "integer");
 
     auto constInteger = construct<IntegerValue>(integer);
 
@@ -361,7 +365,7 @@ auto expression_parser() {
 
     auto real_parser = parse_index<0, 2, 3>::select(decnumber, symbol('.'), decnumber, maybe(scale_parser));
 
-    ParserPtr<Real> real = extension(real_parser, &parse_real);
+    ParserPtr<Real> real = named(extension(real_parser, &parse_real), "real");
 
     auto constReal = construct<RealValue>(real);
 
@@ -369,33 +373,35 @@ auto expression_parser() {
         construct<CharValue>(either({parse_index<1>::select(symbol('\''), any, symbol('\'')),
                                 construct<char>(parse_index<0>::select(hexnumber, symbol('X')))}));
 
-    ParserPtr<StringValue> string = construct<StringValue>(parse_index<1>::select(symbol('"'), many(inverse('"')), symbol('"')));
+    ParserPtr<StringValue> string = named(construct<StringValue>(parse_index<1>::select(symbol('"'), many(inverse('"')), symbol('"'))), "string");
     ParserPtr<StringValue> singleCharString = construct<StringValue>(parse_index<1>::select(symbol('"'), inverse('"'), symbol('"')));
 
     ParserPtr<SetElement> set_element =
         construct<SetElement>(sequence(expression, maybe(syntax_index<1>::select(symbols(".."), expression))));
 
-    ParserPtr<Set> set =
-        construct<Set>(syntax_index<1>::select(symbol('{'), maybe(extra_delim(set_element, symbol(','))), symbol('}')));
+    ParserPtr<Set> set = named(
+        construct<Set>(syntax_index<1>::select(symbol('{'), maybe(extra_delim(set_element, symbol(','))), symbol('}'))), "set");
 
     ParserPtr<ExpList> expList = extra_delim(expression, symbol(','));
 
-    ParserPtr<Designator> designator = construct<Designator>(
+    ParserPtr<Designator> designator = named(construct<Designator>(
         syntax_sequence(qualident, many(variant(parse_index<1>::select(symbol('.'), ident),
                                                 syntax_index<1>::select(symbol('['), expList, symbol(']')), symbol('^'),
-                                                syntax_index<1>::select(symbol('('), qualident, symbol(')'))))));
+                                                syntax_index<1>::select(symbol('('), qualident, symbol(')')))))), "designator");
 
     ParserPtr<ExpList> actualParameters = syntax_index<1>::select(symbol('('), maybe_list(expList), symbol(')'));
 
     auto commonParams = syntax_index<1>::select(symbol('{'), extra_delim(qualident, symbol(',')), symbols("}."));
 
     auto baseProcedureType = either({symbols("ABS"),symbols("ODD"),symbols("LEN"),symbols("LSL"),symbols("ASR"),symbols("ROR"),
-        symbols("FLOOR"),symbols("FLT"),symbols("ORD"),symbols("CHR"),symbols("INC"),symbols("DEC"),symbols("INCL"),symbols("EXCL"),
+        symbols("FLOOR"),symbols("FLT"),symbols("ORD"),symbols("CHR"),symbols("INCL"),symbols("INC"),symbols("DEC"),symbols("EXCL"),
         symbols("NEW"),symbols("ASSERT"),symbols("PACK"),symbols("UNPK")});
 
-    ParserPtr<BaseProcedureValue> baseProcedure = construct<BaseProcedureValue>(sequence(baseProcedureType, actualParameters));
+    ParserPtr<BaseProcedureValue> baseProcedure =
+        named(construct<BaseProcedureValue>(sequence(baseProcedureType, actualParameters)), "built-in call");
 
-    ParserPtr<ProcCall> procCall = construct<ProcCall>(sequence(maybe(commonParams), designator, maybe(actualParameters)));
+    ParserPtr<ProcCall> procCall =
+        named(construct<ProcCall>(sequence(maybe(commonParams), designator, maybe(actualParameters))), "procedure call");
 
     ParserLinker<ExpressionPtr> factorLink;
 
@@ -404,32 +410,34 @@ auto expression_parser() {
     auto preFactor =
         either({node_either<Expression>(charConst, constReal, constInteger, string, nil, boolean, baseProcedure, procCall, set, tilda),
                 syntax_index<1>::select(symbol('('), expression, symbol(')'))});
-    auto factor = factorLink.link(preFactor);
+    auto factor = factorLink.link(named(preFactor, "factor"));
 
     ParserPtr<Operator> mulOperator = either({construct<Operator>(either({keyword("DIV"), keyword("MOD")})),
                                               construct<Operator>(either({symbols("*"), symbols("/"), symbols("&")}))});
 
-    ParserLinker<ExpressionPtr> termLink;
-    auto preTerm = node_either<Expression>(
-        construct<Term>(syntax_sequence(factor, maybe(syntax_sequence(mulOperator, termLink.get())))));
-    auto term = termLink.link(preTerm);
-
     ParserPtr<Operator> addOperator =
         either({construct<Operator>(keyword("OR")), construct<Operator>(either({symbols("+"), symbols("-")}))});
 
-    ParserLinker<ExpressionPtr> simpleExpressionLink;
-    auto preSimpleExpression = node_either<Expression>(
-        construct<Term>(syntax_sequence(maybe(either({symbol('+'), symbol('-')})), term,
-                                        maybe(syntax_sequence(addOperator, simpleExpressionLink.get())))));
-    auto simpleExpression = simpleExpressionLink.link(preSimpleExpression);
-
     ParserPtr<Operator> relation = either({construct<Operator>(either({keyword("IN"), keyword("IS")})),
                                            construct<Operator>(either({symbols("<="), symbols(">="), symbols("<"),
                                                                        symbols(">"), symbols("#"), symbols("=")}))});
 
-    auto preExpression = node_either<Expression>(
-        construct<Term>(syntax_sequence(simpleExpression, maybe(syntax_sequence(relation, simpleExpression)))));
-    auto realExpression = expressionLink.link(preExpression);
+    auto preExpression = precedence_climbing<ExpressionPtr, Operator, char>(
+        parse_index<0>::select(factor, delim),
+        {{parse_index<0>::select(relation, delim), 1},
+         {parse_index<0>::select(addOperator, delim), parse_index<0>::select(either({symbol('+'), symbol('-')}), delim)},
+         {parse_index<0>::select(mulOperator, delim)}},
+        [](size_t, CodePlace place, std::optional<char> sign, ExpressionPtr first,
+           std::vector<std::pair<Operator, ExpressionPtr>> operations) -> ExpressionPtr {
+            if (!sign && operations.empty()) return first;
+            std::vector<Term::Operation> chain;
+            chain.reserve(operations.size());
+            for (auto& [oper, operand] : operations) chain.push_back({oper, std::move(operand)});
+            auto term = make_expression<Term>(sign, std::move(first), std::move(chain));
+            term->place = place;
+            return term;
+        });
+    auto realExpression = expressionLink.link(named(preExpression, "expression"));
 
     auto lbl = variant(integer, singleCharString, qualident);
     auto commonFeature = construct<CommonFeature>(variant(ident, constInteger, string));
@@ -450,7 +458,7 @@ auto statement_parser(ParserPtr<ExpressionPtr> expression, ParserPtr<Label> lbl,
         chain(syntax_index<1, 3>::select(keyword("IF"), expression, keyword("THEN"), statementSequence), many(elsif)),
         maybe(syntax_index<1>::select(keyword("ELSE"), statementSequence)), keyword("END")));
 
-    auto caseLabel = construct<CaseLabel>(syntax_sequence(lbl, maybe(syntax_index<1>::select(symbols(".."), lbl))));
+    auto caseLabel = set_place(construct<CaseLabel>(syntax_sequence(lbl, maybe(syntax_index<1>::select(symbols(".."), lbl)))));
 
     auto caseLabelList = extra_delim(caseLabel, symbols(","));
 
@@ -471,10 +479,15 @@ auto statement_parser(ParserPtr<ExpressionPtr> expression, ParserPtr<Label> lbl,
         keyword("FOR"), ident, symbols(":="), expression, keyword("TO"), expression,
         maybe(syntax_index<1>::select(keyword("BY"), expression)), keyword("DO"), statementSequence, keyword("END")));
 
-    auto statement = node_either<Statement>(assignment, construct<CallStatement>(node_either<Expression>(baseProcedure, procCall)), ifStatement,
-                                            caseStatement, whileStatement, repeatStatement, forStatement);
-    auto realStatementSequence =
-        statementSequenceLink.link(unwrap_maybe_list(extra_delim(maybe(statement), symbols(";"))));
+    auto callStatement = construct<CallStatement>(node_either<Expression>(baseProcedure, procCall));
+    auto statement = named(node_either<Statement>(named(assignment, "assignment"), named(callStatement, "call statement"),
+                                                  named(ifStatement, "if statement"), named(caseStatement, "case statement"),
+                                                  named(whileStatement, "while statement"),
+                                                  named(repeatStatement, "repeat statement"),
+                                                  named(forStatement, "for statement")),
+                           "statement");
+    auto realStatementSequence = statementSequenceLink.link(
+        named(unwrap_maybe_list(extra_delim(maybe(statement), symbols(";"))), "statement sequence"));
 
     return realStatementSequence;
 }
@@ -484,9 +497,10 @@ auto declarations_parser(ParserPtr<TypePtr> type, ParserPtr<ExpressionPtr> expre
     auto variableDecl = fieldList;
 
     ParserPtr<ConstDecl> constDecl =
-        construct<ConstDecl>(syntax_index<0, 2>::select(identdef, symbol('='), expression));
+        named(construct<ConstDecl>(syntax_index<0, 2>::select(identdef, symbol('='), expression)), "const declaration");
 
-    ParserPtr<TypeDecl> typeDecl = construct<TypeDecl>(syntax_index<0, 2>::select(identdef, symbol('='), type));
+    ParserPtr<TypeDecl> typeDecl =
+        named(construct<TypeDecl>(syntax_index<0, 2>::select(identdef, symbol('='), type)), "type declaration");
 
     ParserLinker<DeclarationSequence> declarationSequenceLink;
 
@@ -502,7 +516,7 @@ auto declarations_parser(ParserPtr<TypePtr> type, ParserPtr<ExpressionPtr> expre
     auto procedureDeclBase = construct<ProcedureDeclaration>(syntax_index<1, 2, 3>::select(
         keyword("PROCEDURE"), identdef, construct<ProcedureType>(maybe(formalParameters)), procDeclBody));
 
-    auto procedureDecl = node_either<Section>(parse_index<0>::tuple_select(
+    auto procedureDecl = named(node_either<Section>(parse_index<0>::tuple_select(
       except(syntax_sequence(procedureDeclBase, maybe(ident)), "same ident and rettype", [](const auto& pair) {
             auto& [proc, ident] = pair;
             if (proc.body) {
@@ -510,7 +524,7 @@ auto declarations_parser(ParserPtr<TypePtr> type, ParserPtr<ExpressionPtr> expre
                 return proc.name.ident == ident.value()
                     && (!proc.type.params.rettype == !(proc.body && proc.body->ret));
             } else return true;
-        })));
+        }))), "procedure declaration");
 
     auto preDeclarationSequence = construct<DeclarationSequence>(
         syntax_sequence(maybe_list(syntax_index<1>::select(keyword("CONST"), extra_delim0(constDecl, symbol(';')))),
@@ -518,7 +532,7 @@ auto declarations_parser(ParserPtr<TypePtr> type, ParserPtr<ExpressionPtr> expre
                         maybe_list(syntax_index<1>::select(keyword("VAR"), extra_delim0(variableDecl, symbol(';')))),
                         maybe_list(extra_delim0(procedureDecl, symbol(';')))));
 
-    auto declarationSequence = declarationSequenceLink.link(preDeclarationSequence);
+    auto declarationSequence = declarationSequenceLink.link(named(preDeclarationSequence, "declaration sequence"));
 
     return std::tuple{declarationSequence, constDecl, typeDecl, variableDecl};
 }
@@ -527,7 +541,8 @@ auto module_parser(ParserPtr<DeclarationSequence> declarationSequence, ParserPtr
 
     auto import = construct<Import>(syntax_sequence(ident, maybe(syntax_index<1>::select(symbols(":="), ident))));
 
-    auto importList = syntax_index<1>::select(keyword("IMPORT"), extra_delim(import, symbol(',')), symbol(';'));
+    auto importList =
+        named(syntax_index<1>::select(keyword("IMPORT"), extra_delim(import, symbol(',')), symbol(';')), "import list");
 
     auto moduleBase = construct<Module>(syntax_index<1, 3, 4, 5>::select(
         keyword("MODULE"), ident, symbol(';'), maybe_list(importList), declarationSequence,
@@ -579,5 +594,5 @@ ParserPtr<std::shared_ptr<IModule>> get_parsers() {
 
     auto definition = definition_parser(importList, constDecl, typeDecl, variableDecl, formalParameters);
 
-    return parse_index<1>::select(delim, node_either<IModule>(module, definition));
+    return parse_index<1>::select(delim, node_either<IModule>(named(module, "module"), named(definition, "definition")));
 }
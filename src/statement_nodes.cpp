@@ -1,4 +1,5 @@
 #include "statement_nodes.hpp"
+#include "ast_stats.hpp"
 #include "expression_nodes.hpp"
 #include "message_container.hpp"
 #include "node_formatters.hpp"
@@ -7,6 +8,9 @@
 #include "symbol_table.hpp"
 #include "type.hpp"
 
+#include <algorithm>
+#include <ranges>
+
 using namespace nodes;
 
 inline bool check_statements(Context& context, const StatementSequence& seq) {
@@ -25,7 +29,7 @@ std::string Assignment::to_string() const {
 bool Assignment::check(Context& context) const {
     if (!variable.repair(context))
         return berror;
-    auto validIdent = variable.get();
+    auto& validIdent = variable.get();
     auto lsymbol = validIdent.get_symbol(context, place);
     if (!lsymbol)
         return berror;
@@ -41,8 +45,7 @@ bool Assignment::check(Context& context) const {
     if (lltype.assignment_compatible(context, *rrtype)) {
         return bsuccess;
     } else {
-        context.messages.addErr(place, "Incompatible types in assignment: {} and {}", lsymbol->type->to_string(),
-                                rrtype->to_string());
+        context.messages.addErr(place, "Incompatible types in assignment: {} and {}", *lsymbol->type, *rrtype);
         return berror;
     }
 }
@@ -91,6 +94,63 @@ std::string CaseStatement::to_string() const {
     return fmt::format("CASE {} OF {} END", expression, fmt::join(cases, " |\n"));
 }
 
+inline std::string show_label(Integer value, size_t label_index) {
+    return label_index == 0 ? fmt::format("{}", value) : fmt::format("\"{}\"", char(value));
+}
+
+inline std::string show_interval(const CaseInterval& interval, size_t label_index) {
+    if (interval.low == interval.high) return show_label(interval.low, label_index);
+    return fmt::format("{}..{}", show_label(interval.low, label_index), show_label(interval.high, label_index));
+}
+
+//! Smallest number of intervals for which a jump table is preferred over a search
+constexpr size_t jump_table_min_intervals = 4;
+//! Minimal percentage of values in the label range that select some case, for a jump table
+constexpr uint64_t jump_table_min_density = 40;
+constexpr size_t bit_test_max_branches = 3;
+
+/*!
+ * Sorts the label intervals, reports duplicates and overlaps at the later
+ * label by comparing neighbours, and picks the lowering: bit tests for a few cases over a range
+ * that fits a machine word, a jump table for dense labels, otherwise a binary
+ * search over the intervals.
+ */
+Maybe<CaseDispatch> plan_case_dispatch(Context& context, std::vector<CaseInterval> intervals, size_t label_index) {
+    if (intervals.empty()) return error;
+    std::ranges::stable_sort(intervals, {}, &CaseInterval::low);
+    auto overlap = false;
+    for (size_t i = 1; i < intervals.size(); i++) {
+        auto& prev = intervals[i - 1];
+        auto& cur = intervals[i];
+        if (cur.low > prev.high) continue;
+        overlap = true;
+        if (cur.low == prev.low && cur.high == prev.high)
+            context.messages.addErr(cur.place, "Duplicate case label {}", show_interval(cur, label_index));
+        else
+            context.messages.addErr(cur.place, "Case labels {} and {} overlap", show_interval(prev, label_index),
+                                    show_interval(cur, label_index));
+        // Keep the wider interval as the neighbour of the next one
+        if (prev.high > cur.high) std::swap(prev, cur);
+    }
+    if (overlap) return error;
+
+    CaseDispatch plan{CaseDispatch::BINARY_SEARCH, intervals.front().low, intervals.back().high, std::move(intervals)};
+    uint64_t span = uint64_t(int64_t(plan.high) - plan.low) + 1;
+    uint64_t covered = 0;
+    std::vector<bool> branches;
+    for (auto& interval : plan.intervals) {
+        covered += uint64_t(int64_t(interval.high) - interval.low) + 1;
+        if (interval.branch >= branches.size()) branches.resize(interval.branch + 1);
+        branches[interval.branch] = true;
+    }
+    auto branch_count = size_t(std::ranges::count(branches, true));
+    if (span <= 64 && branch_count <= bit_test_max_branches && plan.intervals.size() > branch_count)
+        plan.kind = CaseDispatch::BIT_TEST;
+    else if (plan.intervals.size() >= jump_table_min_intervals && covered * 100 >= span * jump_table_min_density)
+        plan.kind = CaseDispatch::JUMP_TABLE;
+    return plan;
+}
+
 bool CaseStatement::check(Context& context) const {
     if (cases.size() == 0) return true;
     auto label_index = std::get<0>(cases[0]).front().first.index();
@@ -112,20 +172,33 @@ bool CaseStatement::check(Context& context) const {
     }
 
     auto result = bsuccess;
-    for (auto& [label_list, statements] : cases) {
+    if (label_index == 0 && (!expr_basetype || expr_basetype->type != BaseType::INTEGER)) {
+        context.messages.addErr(expression->place, "Expected expression of INTEGER type");
+        result = berror;
+    } else if (label_index == 1 && (!expr_basetype || expr_basetype->type != BaseType::CHAR)) {
+        context.messages.addErr(expression->place, "Expected expression of CHAR type");
+        result = berror;
+    }
+    // Intervals of all valid labels are collected even after an error, so that overlaps are still reported
+    std::vector<CaseInterval> intervals;
+    for (size_t branch = 0; branch < cases.size(); branch++) {
+        auto& [label_list, statements] = cases[branch];
         for (auto& label : label_list) {
             if (label.first.index() != label_index || (label.second && label.second->index() != label_index)) {
-                context.messages.addErr(place, "Different label types in case statement");
-                result = berror;
-            } else if (label_index == 0 && (!expr_basetype || expr_basetype->type != BaseType::INTEGER)) {
-                context.messages.addErr(place, "Expected expression of INTEGER type");
+                context.messages.addErr(label.place, "Different label types in case statement: {}", label);
                 result = berror;
-            } else if (label_index == 1 && (!expr_basetype || expr_basetype->type != BaseType::CHAR)) {
-                context.messages.addErr(place, "Expected expression of CHAR type");
-                result = berror;
-            } else if (label_index == 2) {
+            } else if (label_index != 2) {
+                auto low = label_value(label.first);
+                auto high = label.second ? label_value(*label.second) : low;
+                if (low > high) {
+                    context.messages.addErr(label.place, "Empty label range {}..{}", show_label(low, label_index), show_label(high, label_index));
+                    result = berror;
+                } else {
+                    intervals.push_back({low, high, branch, label.place});
+                }
+            } else {
                 if (label.second) {
-                    context.messages.addErr(place, "Unexpected label range for type labels");
+                    context.messages.addErr(label.place, "Unexpected label range for type labels: {}", label);
                     result = berror;
                     continue;
                 }
@@ -136,13 +209,19 @@ bool CaseStatement::check(Context& context) const {
                     continue;
                 }
                 if (!expr_record->assignment_compatible(context, *symbol->type)) {
-                    context.messages.addErr(ident.ident.place, "Expected extension of type: {}", expr_type->to_string());
+                    context.messages.addErr(ident.ident.place, "Expected extension of type: {}", *expr_type);
                     result = berror;
                 }
             }
         }
         if (!check_statements(context, statements)) result = berror;
     }
+    if (label_index != 2) {
+        auto plan = plan_case_dispatch(context, std::move(intervals), label_index);
+        if (!plan || !result) return berror;
+        dispatch = std::move(plan);
+        if (AstStats::enabled()) AstStats::instance().count_case(*dispatch);
+    }
     return result;
 }
 
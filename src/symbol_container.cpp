@@ -1,6 +1,10 @@
 #include "symbol_container.hpp"
+#include "constant_folding.hpp"
+#include "name_resolution.hpp"
 #include "node.hpp"
 #include "procedure_table.hpp"
+#include "time_report.hpp"
+#include "type_interner.hpp"
 
 bool SymbolContainer::parse(SymbolContainer& table, nodes::Context& context, const nodes::DeclarationSequence& seq, nodes::StatementSequence body, std::function<bool(nodes::IdentDef,nodes::Context&)> func)  {
     table.body = body;
@@ -20,21 +24,30 @@ bool SymbolContainer::parse(SymbolContainer& table, nodes::Context& context, con
     std::vector<nodes::TypeDecl> unchecked_types;
     for (auto& decl : seq.typeDecls) {
         nodes::TypePtr type;
-        if (auto pointer = dynamic_cast<nodes::PointerType*>(decl.type.get()); pointer) {
+        if (auto pointer = nodes::dyn_cast<nodes::PointerType>(decl.type.get()); pointer) {
             unchecked_types.push_back(decl);
             type = decl.type;
         } else {
             auto res = decl.type->normalize(context, false);
             if (!res) return berror;
             type = *res;
+            // Field tables and layouts of declared records and arrays are ready before any use
+            if (type->is<nodes::RecordType>() || type->is<nodes::ArrayType>()) {
+                auto laid_out = with_interner([&](TypeInterner& interner) {
+                    if (!interner.layout(context, *type)) return false;
+                    if (TypeInterner::dump_enabled()) interner.dump_layout(context, decl.ident.ident.place, decl.ident.ident, *type);
+                    return true;
+                });
+                if (!laid_out) return berror;
+            }
         }
         if (!func(decl.ident, context)) return berror;
         auto res = table.add_symbol(context.messages, decl.ident, SymbolGroup::TYPE, type);
         if (!res) return berror;
     }
     for (auto& decl : unchecked_types) {
-        auto type = table.symbols[decl.ident.ident].type;
-        auto res = dynamic_cast<nodes::PointerType*>(type.get())->check_type(context);
+        auto type = table.find(decl.ident.ident)->symbol.type;
+        auto res = nodes::dyn_cast<nodes::PointerType>(type.get())->check_type(context);
         if (!res) return berror;
     }
     for (auto& decl : seq.variableDecls) {
@@ -49,11 +62,14 @@ bool SymbolContainer::parse(SymbolContainer& table, nodes::Context& context, con
         }
     }
     for (auto& _decl : seq.procedureDecls) {
-        auto decl = *dynamic_cast<nodes::ProcedureDeclaration*>(_decl.get());
-        if (auto type = decl.type.normalize(context, false); !type) {
+        auto& declared = *nodes::dyn_cast<nodes::ProcedureDeclaration>(_decl.get());
+        auto decl = declared;
+        // Normalize the declared node, not the local copy: normalized forms are cached by node address
+        if (auto type = declared.type.normalize(context, false); !type) {
             return berror;
         } else {
             decl.type = *type.value()->is<nodes::ProcedureType>();
+            PhaseTimer timer("procedure {}", decl.name.ident);
             auto res = build_procedure_table(decl, &context.symbols, context.messages);
             if (!res.get()) return berror;
             if (!func(decl.name, context)) return berror;
@@ -61,30 +77,61 @@ bool SymbolContainer::parse(SymbolContainer& table, nodes::Context& context, con
             if (!res1) return berror;
         }
     }
+    // All names of the scope are declared, constants in the body can be folded once
+    ConstantFolder folder(context);
+    table.body = folder.fold(table.body);
+    table.pruned = std::move(folder.pruned());
     return bsuccess;
 }
 
 bool SymbolContainer::analyze_code(nodes::Context& context) const {
     auto serror = false;
-    for (auto& [name, table] : tables) {
-        auto res = table->analyze_code(context.messages);
+    for (auto& entry : m_entries) {
+        if (!entry.table) continue;
+        PhaseTimer timer("procedure {}", entry.symbol.name.ident);
+        auto res = entry.table->analyze_code(context.messages);
         if (!res) serror = true;
     }
+    resolve_names(context.symbols, body);
+    resolve_names(context.symbols, pruned);
     for (auto& statement : body) {
         auto res = statement->check(context);
         if (!res) serror = true;
     }
-    // for (auto [name, symbol] : symbols) {
-    //     if (symbol.count == 0)
-    //         context.messages.addFormat(MPriority::W4, symbol.name.ident.place, "Unused symbol: {}", symbol.name);
+    for (auto& statement : pruned) {
+        auto res = statement->check(context);
+        if (!res) serror = true;
+    }
+    // for (auto& entry : m_entries) {
+    //     if (entry.symbol.count == 0)
+    //         context.messages.addFormat(MPriority::W4, entry.symbol.name.ident.place, "Unused symbol: {}", entry.symbol.name);
     // }
     if (serror) return berror;
     return bsuccess;
 }
 
+std::optional<uint32_t> SymbolContainer::slot_of(const nodes::Ident& ident) const {
+    if (m_index.empty()) return {};
+    auto mask = m_index.size() - 1;
+    for (auto bucket = std::hash<nodes::Ident>{}(ident) & mask;; bucket = (bucket + 1) & mask) {
+        auto slot = m_index[bucket];
+        if (slot == empty_bucket) return {};
+        if (m_entries[slot].symbol.name.ident == ident) return slot;
+    }
+}
+
+void SymbolContainer::grow_index() {
+    m_index.assign(m_index.empty() ? 16 : m_index.size() * 2, empty_bucket);
+    auto mask = m_index.size() - 1;
+    for (uint32_t slot = 0; slot < m_entries.size(); ++slot) {
+        auto bucket = std::hash<nodes::Ident>{}(m_entries[slot].symbol.name.ident) & mask;
+        while (m_index[bucket] != empty_bucket) bucket = (bucket + 1) & mask;
+        m_index[bucket] = slot;
+    }
+}
+
 bool SymbolContainer::add_symbol(MessageContainer& messages, nodes::IdentDef ident, SymbolGroup group, nodes::TypePtr type) {
-    if (symbols.contains(ident.ident)) {
-        auto symbol = symbols[ident.ident];
+    if (slot_of(ident.ident)) {
         messages.addErr(ident.ident.place, "Redefinition of symbol {}", ident.ident);
         // messages.addFormat(MPriority::W1, ident.ident.place, "{} First definition here", symbol.name.ident.place);
         // messages.addFormat(MPriority::W1, ident.ident.place, "{} Second definition here", ident.ident.place);
@@ -95,7 +142,15 @@ bool SymbolContainer::add_symbol(MessageContainer& messages, nodes::IdentDef ide
         symbol.group = group;
         symbol.type = type;
         symbol.count = 0;
-        symbols[ident.ident] = symbol;
+        m_entries.push_back(SymbolEntry{std::move(symbol), nullptr, nullptr});
+        if (2 * m_entries.size() > m_index.size()) {
+            grow_index();
+        } else {
+            auto mask = m_index.size() - 1;
+            auto bucket = std::hash<nodes::Ident>{}(ident.ident) & mask;
+            while (m_index[bucket] != empty_bucket) bucket = (bucket + 1) & mask;
+            m_index[bucket] = uint32_t(m_entries.size() - 1);
+        }
         return bsuccess;
     }
 }
@@ -105,101 +160,92 @@ bool SymbolContainer::add_value(MessageContainer& messages, nodes::IdentDef iden
     if (auto res = add_symbol(messages, ident, group, type); !res) {
         return berror;
     } else {
-        values[ident.ident] = value;
+        m_entries.back().value = std::move(value);
+        m_values++;
         return bsuccess;
     }
 }
 
 bool SymbolContainer::add_table(MessageContainer& messages, nodes::IdentDef ident, SymbolGroup group, nodes::TypePtr type, TablePtr table) {
-    if (auto tableRes = get_table(messages, nodes::QualIdent{{}, ident.ident}, true); tableRes) {
-        if (tableRes.value()->can_overload(messages, *table)) {
-            if (&tableRes.value()->parent().get_symbols() == this) {
-                return tableRes.value()->overload(messages, table);
+    if (auto entry = find_mut(ident.ident); entry && entry->table) {
+        auto& existing = entry->table;
+        if (existing->can_overload(messages, *table)) {
+            if (&existing->parent().get_symbols() == this) {
+                return existing->overload(messages, table);
             } else {
-                tables[ident.ident] = std::move(table);
+                existing = std::move(table);
                 return bsuccess;
             }
         }
-        return tableRes.value()->overload(messages, table);
+        return existing->overload(messages, table);
     }
     if (auto res = add_symbol(messages, ident, group, type); !res) {
         return berror;
     } else {
-        tables[ident.ident] = std::move(table);
+        m_entries.back().table = std::move(table);
+        m_tables++;
         return bsuccess;
     }
 }
 
 Maybe<SymbolToken> SymbolContainer::get_symbol(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const {
-    auto msg = Message(MPriority::ERR, ident.ident.place, fmt::format("Symbol {} not found", ident));
-    if (ident.qual) {
-        if (!secretly)
-            messages.addMessage(msg);
-        return error;
-    } else {
-        if (auto res = symbols.find(ident.ident); res != symbols.end()) {
-            if (!secretly)
-                const_cast<SymbolContainer*>(this)->symbols[ident.ident].count++;
-            return SymbolToken(res->second);
-        } else {
-            if (!secretly)
-                messages.addMessage(msg);
-            return error;
-        }
-    }
+    if (!ident.qual)
+        if (auto slot = slot_of(ident.ident); slot)
+            return secretly ? symbol_at(*slot) : use_symbol(*slot);
+    if (!secretly)
+        messages.addErr(ident.ident.place, "Symbol {} not found", ident);
+    return error;
 }
 
 Maybe<nodes::ValuePtr> SymbolContainer::get_value(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const {
-    auto msg = Message(MPriority::ERR, ident.ident.place, fmt::format("Symbol {} not found", ident));
-    if (ident.qual) {
-        if (!secretly)
-            messages.addMessage(msg);
-        return error;
-    } else {
-        if (auto res = values.find(ident.ident); res != values.end()) {
-            if (!secretly)
-                const_cast<SymbolContainer*>(this)->symbols[ident.ident].count++;
-            return nodes::ValuePtr(res->second);
-        } else {
-            if (!secretly)
-                messages.addMessage(msg);
-            return error;
+    if (!ident.qual)
+        if (auto slot = slot_of(ident.ident); slot && m_entries[*slot].value) {
+            if (!secretly) use_symbol(*slot);
+            return m_entries[*slot].value;
         }
-    }
+    if (!secretly)
+        messages.addErr(ident.ident.place, "Symbol {} not found", ident);
+    return error;
 }
 
 Maybe<TablePtr> SymbolContainer::get_table(MessageContainer& messages, const nodes::QualIdent& ident, bool secretly) const {
-    auto msg = Message(MPriority::ERR, ident.ident.place, fmt::format("Symbol {} not found", ident));
-    if (ident.qual) {
-        if (!secretly)
-            messages.addMessage(msg);
-        return error;
-    } else {
-        if (auto res = tables.find(ident.ident); res != tables.end()) {
-            if (!secretly)
-                const_cast<SymbolContainer*>(this)->symbols[ident.ident].count++;
-            return TablePtr(res->second);
-        } else {
-            if (!secretly)
-                messages.addMessage(msg);
-            return error;
+    if (!ident.qual)
+        if (auto slot = slot_of(ident.ident); slot && m_entries[*slot].table) {
+            if (!secretly) use_symbol(*slot);
+            return m_entries[*slot].table;
         }
+    if (!secretly)
+        messages.addErr(ident.ident.place, "Symbol {} not found", ident);
+    return error;
+}
+
+std::optional<SymbolBinding> SymbolTable::bind(const nodes::Ident& ident) const {
+    auto scopes = display();
+    for (auto depth = scopes.size(); depth-- > 0;) {
+        if (auto slot = scopes[depth]->slot_of(ident); slot)
+            return SymbolBinding{uint32_t(depth), *slot};
     }
+    return {};
+}
+
+const SymbolToken& SymbolTable::bound_symbol(SymbolBinding binding, bool secretly) const {
+    auto& scope = *display()[binding.depth];
+    return secretly ? scope.symbol_at(binding.slot) : scope.use_symbol(binding.slot);
 }
 
 std::string SymbolContainer::to_string() const {
     std::string result;
-    result += fmt::format("Symbols ({}):\n", symbols.size());
-    for (auto [name, symbol] : symbols) {
-        result += fmt::format("{}: {}\n", name, symbol);
+    result += fmt::format("Symbols ({}):\n", m_entries.size());
+    for (auto& entry : m_entries) {
+        result += fmt::format("{}: {}\n", entry.symbol.name.ident, entry.symbol);
     }
-    result += fmt::format("Values ({}):\n", values.size());
-    for (auto [name, value] : values) {
-        result += fmt::format("{}: {}\n", name, value->to_string());
+    result += fmt::format("Values ({}):\n", m_values);
+    for (auto& entry : m_entries) {
+        if (entry.value) result += fmt::format("{}: {}\n", entry.symbol.name.ident, entry.value->to_string());
     }
-    result += fmt::format("Tables ({}):\n", tables.size());
-    for (auto [name, table] : tables) {
-        result += fmt::format("{}:\n{}\n", name, table->to_string());
+    result += fmt::format("Tables ({}):\n", m_tables);
+    for (auto& entry : m_entries) {
+        if (entry.table) result += fmt::format("{}:\n{}\n", entry.symbol.name.ident, entry.table->to_string());
     }
     return result;
 }
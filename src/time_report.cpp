@@ -0,0 +1,124 @@
+#include "time_report.hpp"
+#include <algorithm>
+#include <fstream>
+
+using namespace std::chrono;
+
+TimeReport& TimeReport::instance() noexcept {
+    static TimeReport report;
+    return report;
+}
+
+TimeReport::TimeReport() {
+    m_nodes.push_back(Node{"total", 0, {}});
+}
+
+void TimeReport::enable(bool trace) noexcept {
+    m_enabled = true;
+    m_trace = m_trace || trace;
+    m_origin = Clock::now();
+}
+
+size_t TimeReport::enter(std::string name) {
+    for (auto child : m_nodes[m_current].children) {
+        if (m_nodes[child].name == name) {
+            m_current = child;
+            return child;
+        }
+    }
+    size_t index = m_nodes.size();
+    m_nodes.push_back(Node{std::move(name), m_current, {}});
+    m_nodes[m_current].children.push_back(index);
+    m_current = index;
+    return index;
+}
+
+void TimeReport::leave(size_t node, Clock::time_point start, Clock::time_point end) {
+    auto& data = m_nodes[node];
+    data.count++;
+    data.total += end - start;
+    if (m_current == node) m_current = data.parent;
+    if (m_trace) {
+        m_events.push_back(TraceEvent{node, duration_cast<microseconds>(start - m_origin).count(),
+                                      duration_cast<microseconds>(end - start).count()});
+    }
+}
+
+void TimeReport::leave_memory(size_t node, const AllocCounters& before, size_t outer_peak) noexcept {
+    auto now = alloc_stats::counters();
+    auto& data = m_nodes[node];
+    data.allocations += now.allocations - before.allocations;
+    data.bytes += now.bytes - before.bytes;
+    data.peak = std::max(data.peak, now.peak);
+    alloc_stats::merge_peak(outer_peak);
+}
+
+inline double to_ms(TimeReport::Clock::duration duration) {
+    return duration_cast<nanoseconds>(duration).count() / 1e6;
+}
+
+void TimeReport::print_node(std::ostream& stream, size_t node, size_t depth, Clock::duration root_total) const {
+    auto& data = m_nodes[node];
+    auto self = data.total;
+    for (auto child : data.children) self -= m_nodes[child].total;
+    double percent = root_total.count() > 0 ? 100.0 * data.total.count() / root_total.count() : 0;
+    stream << fmt::format("{:>12.3f} {:>12.3f} {:>6.1f}% {:>7}  {}{}\n", to_ms(data.total), to_ms(self), percent,
+                          data.count, std::string(2 * depth, ' '), data.name);
+    for (auto child : data.children) print_node(stream, child, depth + 1, root_total);
+}
+
+void TimeReport::print(std::ostream& stream) const {
+    Clock::duration root_total{};
+    for (auto child : m_nodes[0].children) root_total += m_nodes[child].total;
+    stream << format_color(Blue, "Time report:") << "\n";
+    stream << fmt::format("{:>12} {:>12} {:>7} {:>7}  {}\n", "total (ms)", "self (ms)", "%", "count", "phase");
+    for (auto child : m_nodes[0].children) print_node(stream, child, 0, root_total);
+}
+
+inline double to_kb(size_t bytes) {
+    return bytes / 1024.0;
+}
+
+void TimeReport::print_memory_node(std::ostream& stream, size_t node, size_t depth) const {
+    auto& data = m_nodes[node];
+    stream << fmt::format("{:>12} {:>14.1f} {:>14.1f} {:>7}  {}{}\n", data.allocations, to_kb(data.bytes),
+                          to_kb(data.peak), data.count, std::string(2 * depth, ' '), data.name);
+    for (auto child : data.children) print_memory_node(stream, child, depth + 1);
+}
+
+void TimeReport::print_memory(std::ostream& stream) const {
+    stream << format_color(Blue, "Memory report:") << "\n";
+    if (!alloc_stats::enabled()) {
+        stream << "Allocation counters are not available, rebuild with -Dalloc_stats=true\n";
+        return;
+    }
+    stream << fmt::format("{:>12} {:>14} {:>14} {:>7}  {}\n", "allocs", "allocated (KB)", "peak live (KB)", "count",
+                          "phase");
+    for (auto child : m_nodes[0].children) print_memory_node(stream, child, 0);
+    auto total = alloc_stats::counters();
+    stream << fmt::format("{:>12} {:>14.1f} {:>14.1f} {:>7}  {}\n", total.allocations, to_kb(total.bytes),
+                          to_kb(total.peak), 1, "process");
+}
+
+inline std::string json_escape(std::string_view str) {
+    std::string result;
+    for (auto c : str) {
+        if (c == '"' || c == '\\') result.push_back('\\');
+        if (static_cast<unsigned char>(c) < ' ') continue;
+        result.push_back(c);
+    }
+    return result;
+}
+
+bool TimeReport::write_trace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+    file << "{\"traceEvents\":[";
+    for (size_t i = 0; i < m_events.size(); ++i) {
+        auto& event = m_events[i];
+        file << fmt::format("{}\n{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{},\"dur\":{},\"pid\":1,\"tid\":1}}",
+                            i == 0 ? "" : ",", json_escape(m_nodes[event.node].name), event.start, event.duration);
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return file.good();
+}
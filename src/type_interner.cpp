@@ -0,0 +1,152 @@
+#include "type_interner.hpp"
+#include "node_formatters.hpp"
+
+using namespace nodes;
+
+inline size_t hash_combine(size_t seed, size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
+size_t TypeInterner::KeyHash::operator()(const Key& key) const noexcept {
+    size_t hash = key.size();
+    for (auto value : key) hash = hash_combine(hash, std::hash<std::uintptr_t>{}(value));
+    return hash;
+}
+
+size_t TypeInterner::ScopedTypeHash::operator()(const ScopedType& key) const noexcept {
+    return hash_combine(std::hash<const void*>{}(key.first), std::hash<const void*>{}(key.second));
+}
+
+TypeInterner::TypeId TypeInterner::intern(Key key) {
+    return &*m_structural.try_emplace(std::move(key)).first;
+}
+
+TypeInterner::TypeId TypeInterner::identity(Context& context, const Type& type) {
+    switch (type.kind) {
+        case NodeKind::TypeName: {
+            ScopedType key{&type, &context.symbols};
+            if (auto it = m_identities.find(key); it != m_identities.end()) return it->second;
+            auto resolved = static_cast<const TypeName&>(type).dereference(context);
+            if (!resolved) return nullptr;
+            auto id = identity(context, **resolved);
+            if (id) m_identities.emplace(key, id);
+            return id;
+        }
+        case NodeKind::BuiltInType:
+            return make_base_type(static_cast<const BuiltInType&>(type).type).get();
+        case NodeKind::ConstStringType:
+            return &*m_strings.try_emplace(static_cast<const ConstStringType&>(type).size).first;
+        case NodeKind::ImportTypeName:
+            return &*m_imports.try_emplace(static_cast<const ImportTypeName&>(type).ident.ident).first;
+        default:
+            return &type;
+    }
+}
+
+TypeInterner::TypeId TypeInterner::signature(Context& context, const ProcedureType& type) {
+    auto& params = type.params;
+    Key key{std::uintptr_t(NodeKind::ProcedureType), params.common.size()};
+    if (params.rettype) {
+        auto ret = identity(context, **params.rettype);
+        if (!ret) return nullptr;
+        key.push_back(reinterpret_cast<std::uintptr_t>(ret));
+    } else {
+        key.push_back(0);
+    }
+    for (auto list : {&params.common, &params.formal}) {
+        for (auto& param : *list) {
+            auto id = canonical(context, *param.type);
+            if (!id) return nullptr;
+            key.push_back(param.var);
+            key.push_back(reinterpret_cast<std::uintptr_t>(id));
+        }
+    }
+    return intern(std::move(key));
+}
+
+TypeInterner::TypeId TypeInterner::canonical(Context& context, const Type& type) {
+    auto structural = type.is<TypeName>() || type.is<ProcedureType>()
+                   || (type.is<ArrayType>() && static_cast<const ArrayType&>(type).open_array);
+    if (!structural) return identity(context, type);
+    ScopedType key{&type, &context.symbols};
+    if (auto it = m_canonicals.find(key); it != m_canonicals.end()) return it->second;
+    TypeId id = nullptr;
+    if (auto name = type.is<TypeName>(); name) {
+        if (auto resolved = name->dereference(context); resolved) id = canonical(context, **resolved);
+    } else if (auto procedure = type.is<ProcedureType>(); procedure) {
+        id = signature(context, *procedure);
+    } else if (auto element = canonical(context, *static_cast<const ArrayType&>(type).type); element) {
+        id = intern({std::uintptr_t(NodeKind::ArrayType), reinterpret_cast<std::uintptr_t>(element)});
+    }
+    if (id) m_canonicals.emplace(key, id);
+    return id;
+}
+
+bool TypeInterner::same(Context& context, const Type& left, const Type& right) {
+    if (&left == &right) return true;
+    auto left_id = identity(context, left);
+    if (!left_id) return berror;
+    auto right_id = identity(context, right);
+    if (!right_id) return berror;
+    return left_id == right_id;
+}
+
+bool TypeInterner::equal(Context& context, const Type& left, const Type& right) {
+    if (&left == &right) return true;
+    auto left_id = canonical(context, left);
+    if (!left_id) return berror;
+    auto right_id = canonical(context, right);
+    if (!right_id) return berror;
+    return left_id == right_id;
+}
+
+TypePtr TypeInterner::normalized(Context& context, const Type& type, bool normalize_pointers) const {
+    auto& cache = m_normalized[normalize_pointers];
+    if (auto it = cache.find({&type, &context.symbols}); it != cache.end()) return it->second.result;
+    return nullptr;
+}
+
+void TypeInterner::remember_normalized(Context& context, const Type& type, bool normalize_pointers, TypePtr result) {
+    // Without an owner the address may be reused by another node once this one is freed
+    auto owner = type.weak_from_this().lock();
+    if (!owner) return;
+    m_normalized[normalize_pointers].emplace(ScopedType{&type, &context.symbols}, Normalized{std::move(owner), std::move(result)});
+}
+
+const RecordType* TypeInterner::base_record(Context& context, const RecordType& record) {
+    auto symbol = context.symbols.get_symbol(context.messages, *record.basetype);
+    if (!symbol) return nullptr;
+    auto base = symbol->type;
+    if (auto name = base->is<TypeName>(); name) {
+        auto resolved = name->dereference(context);
+        if (!resolved) return nullptr;
+        base = *resolved;
+    }
+    auto result = base->is<RecordType>();
+    if (!result) context.messages.addErr(record.basetype->ident.place, "Base type {} is not a record type", *record.basetype);
+    return result;
+}
+
+const std::vector<TypeInterner::TypeId>* TypeInterner::display(Context& context, const RecordType& record) {
+    if (auto it = m_displays.find(&record); it != m_displays.end()) {
+        if (!it->second.empty()) return &it->second;
+        context.messages.addErr(record.place, "Record type {} extends itself", record);
+        return nullptr;
+    }
+    std::vector<TypeId> result;
+    if (record.basetype) {
+        // An empty display marks a record whose bases are being resolved
+        m_displays.emplace(&record, result);
+        auto base = base_record(context, record);
+        auto base_display = base ? display(context, *base) : nullptr;
+        if (!base_display) {
+            m_displays.erase(&record);
+            return nullptr;
+        }
+        result.reserve(base_display->size() + 1);
+        result.assign(base_display->begin(), base_display->end());
+    }
+    result.push_back(&record);
+    auto& stored = m_displays[&record] = std::move(result);
+    return &stored;
+}
@@ -0,0 +1,166 @@
+#include "type_interner.hpp"
+#include "internal_error.hpp"
+#include "node_formatters.hpp"
+#include "parser_tools.hpp"
+#include <algorithm>
+#include <numeric>
+
+using namespace nodes;
+
+constexpr Layout pointer_layout{8, 8};
+//! An open array is passed as its address and length
+constexpr Layout open_array_layout{16, 8};
+//! Tag of a common type value, stored before the variant
+constexpr Layout common_tag_layout{8, 8};
+
+inline std::uint64_t align_up(std::uint64_t offset, std::uint64_t align) {
+    return (offset + align - 1) / align * align;
+}
+
+inline Layout base_layout(BaseType type) {
+    switch (type) {
+        case BaseType::BOOL:
+        case BaseType::CHAR:
+        case BaseType::BYTE:    return {1, 1};
+        case BaseType::INTEGER: return {sizeof(Integer), alignof(Integer)};
+        case BaseType::REAL:    return {sizeof(Real), alignof(Real)};
+        case BaseType::SET:     return {8, 8};
+        case BaseType::NIL:     return pointer_layout;
+        case BaseType::VOID:    return {0, 1};
+        default: internal::compiler_error("Unexpected BaseType");
+    }
+}
+
+const RecordLayout* TypeInterner::fields(Context& context, const RecordType& record) {
+    if (auto it = m_records.find(&record); it != m_records.end()) return &it->second;
+    auto display = this->display(context, record);
+    if (!display) return nullptr;
+    RecordLayout result;
+    if (display->size() > 1) {
+        // Display entries are the record nodes themselves, the one before the last is the direct base
+        auto base = fields(context, *static_cast<const RecordType*>((*display)[display->size() - 2]));
+        if (!base) return nullptr;
+        result.fields = base->fields;
+        result.index = base->index;
+        result.inherited = base->fields.size();
+    }
+    for (auto& list : record.seq) {
+        for (auto& name : list.list) {
+            auto [it, inserted] = result.index.try_emplace(name.ident, std::uint32_t(result.fields.size()));
+            if (!inserted) {
+                context.messages.addErr(name.ident.place, "Field {} is already declared in {}", name.ident, record);
+                return nullptr;
+            }
+            result.fields.push_back({name.ident, list.type, 0});
+        }
+    }
+    return &m_records.emplace(&record, std::move(result)).first->second;
+}
+
+Maybe<Layout> TypeInterner::layout(Context& context, const Type& type) {
+    switch (type.kind) {
+        case NodeKind::BuiltInType:
+            return base_layout(static_cast<const BuiltInType&>(type).type);
+        case NodeKind::TypeName: {
+            auto resolved = static_cast<const TypeName&>(type).dereference(context);
+            if (!resolved) return error;
+            return layout(context, **resolved);
+        }
+        case NodeKind::RecordType:
+            return record_layout(context, static_cast<const RecordType&>(type));
+        case NodeKind::ArrayType:
+            return array_layout(context, static_cast<const ArrayType&>(type));
+        case NodeKind::ConstStringType:
+            return Layout{static_cast<const ConstStringType&>(type).size, 1};
+        case NodeKind::ScalarType:
+            return layout(context, static_cast<const ScalarType&>(type).get_type());
+        case NodeKind::CommonType: {
+            auto& common = static_cast<const CommonType&>(type);
+            Layout variant{0, 1};
+            auto add_case = [&](const Type& option) {
+                auto res = layout(context, option);
+                if (!res) return false;
+                variant = {std::max(variant.size, res->size), std::max(variant.align, res->align)};
+                return true;
+            };
+            for (auto& pair : common.pair_list)
+                if (!add_case(*pair.type)) return error;
+            if (common.else_clause && !add_case(**common.else_clause)) return error;
+            auto align = std::max(common_tag_layout.align, variant.align);
+            auto size = align_up(common_tag_layout.size, variant.align) + variant.size;
+            return Layout{align_up(size, align), align};
+        }
+        case NodeKind::PointerType:
+        case NodeKind::ProcedureType:
+            return pointer_layout;
+        case NodeKind::ImportTypeName:
+            // Declared without a definition, the value lives behind a handle
+            return pointer_layout;
+        default:
+            internal::compiler_error("Unexpected type in TypeInterner::layout");
+    }
+}
+
+Maybe<Layout> TypeInterner::record_layout(Context& context, const RecordType& record) {
+    if (!fields(context, record)) return error;
+    auto& table = m_records.at(&record);
+    if (table.layout) return table.layout;
+    Layout result{0, 1};
+    if (table.inherited > 0) {
+        auto& display = m_displays.at(&record);
+        auto& base = *static_cast<const RecordType*>(display[display.size() - 2]);
+        auto base_layout = record_layout(context, base);
+        if (!base_layout) return error;
+        result = *base_layout;
+        auto& base_table = m_records.at(&base);
+        for (size_t i = 0; i < table.inherited; i++) table.fields[i].offset = base_table.fields[i].offset;
+    }
+    std::vector<Layout> layouts;
+    for (size_t i = table.inherited; i < table.fields.size(); i++) {
+        auto res = layout(context, *table.fields[i].type);
+        if (!res) return error;
+        layouts.push_back(*res);
+    }
+    std::vector<size_t> order(layouts.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (m_reorder_fields)
+        std::ranges::stable_sort(order, std::greater{}, [&layouts](size_t i) { return layouts[i].align; });
+    for (auto i : order) {
+        result.size = align_up(result.size, layouts[i].align);
+        table.fields[table.inherited + i].offset = result.size;
+        result.size += layouts[i].size;
+        result.align = std::max(result.align, layouts[i].align);
+    }
+    result.size = align_up(result.size, result.align);
+    table.layout = result;
+    return result;
+}
+
+Maybe<Layout> TypeInterner::array_layout(Context& context, const ArrayType& array) {
+    if (array.open_array) return open_array_layout;
+    if (auto it = m_arrays.find(&array); it != m_arrays.end()) return it->second;
+    auto element = layout(context, *array.type);
+    if (!element) return error;
+    auto length = array.length.get(context);
+    if (!length) return error;
+    auto integer = dyn_cast<IntegerValue>(length->get());
+    if (!integer || integer->value < 0) {
+        context.messages.addErr(length.value()->place, "Expected non-negative integer array length");
+        return error;
+    }
+    Layout result{element->size * std::uint64_t(integer->value), element->align};
+    m_arrays.emplace(&array, result);
+    return result;
+}
+
+void TypeInterner::dump_layout(Context& context, CodePlace place, const Ident& name, const Type& type) {
+    auto res = layout(context, type);
+    if (!res) return;
+    auto text = fmt::format("Layout of {}: size {}, align {}", name, res->size, res->align);
+    if (auto record = type.is<RecordType>(); record) {
+        auto& table = m_records.at(record);
+        for (size_t i = 0; i < table.fields.size(); i++)
+            text += fmt::format("{} {} at {}", i == 0 ? "; fields" : ",", table.fields[i].name, table.fields[i].offset);
+    }
+    context.messages.addFormat(MPriority::NOTE, place, "{}", text);
+}
@@ -4,6 +4,7 @@
 #include "parser_tools.hpp"
 #include "semantic_context.hpp"
 #include "type_nodes.hpp"
+#include "type_interner.hpp"
 #include "symbol_table.hpp"
 
 #include <ranges>
@@ -44,37 +45,42 @@ BaseType ident_to_basetype(std::string_view i) {
     internal::compiler_error(fmt::format("Unexpected BaseType ident: '{}'", i));
 }
 
+Maybe<TypePtr> Type::normalize(Context& context, bool normalize_pointers) const {
+    auto interner = TypeInterner::active();
+    if (!interner) return do_normalize(context, normalize_pointers);
+    if (auto cached = interner->normalized(context, *this, normalize_pointers); cached)
+        return cached;
+    auto res = do_normalize(context, normalize_pointers);
+    if (!res)
+        return error;
+    interner->remember_normalized(context, *this, normalize_pointers, *res);
+    return res;
+}
+
+bool Type::same(Context& context, const Type& other) const {
+    return with_interner([&](TypeInterner& interner) { return interner.same(context, *this, other); });
+}
+
+bool Type::equal(Context& context, const Type& other) const {
+    return with_interner([&](TypeInterner& interner) { return interner.equal(context, *this, other); });
+}
+
 bool BuiltInType::equal_to(BaseType other) const {
     return type == other;
 }
 
-BuiltInType::BuiltInType(std::string_view i) : type(ident_to_basetype(i)) {}
+BuiltInType::BuiltInType(std::string_view i) : Type(node_kind), type(ident_to_basetype(i)) {}
 
-BuiltInType::BuiltInType(BaseType t) : type(t) {}
+BuiltInType::BuiltInType(BaseType t) : Type(node_kind), type(t) {}
 
 std::string BuiltInType::to_string() const {
     return fmt::format("@{}", basetype_to_str(type));
 }
 
-Maybe<TypePtr> BuiltInType::normalize(Context&, bool) const {
+Maybe<TypePtr> BuiltInType::do_normalize(Context&, bool) const {
     return make_type<BuiltInType>(*this);
 }
 
-bool BuiltInType::same(Context& context, const Type& other) const {
-    if (auto type_name = other.is<TypeName>(); type_name) {
-        auto other_type = type_name->dereference(context);
-        if (!other_type) return berror;
-        same(context, **other_type);
-    } else if (auto base_type = other.is<BuiltInType>(); base_type) {
-        return type == base_type->type;
-    }
-    return false;
-}
-
-bool BuiltInType::equal(Context& context, const Type& other) const {
-    return same(context, other);
-}
-
 bool BuiltInType::assignment_compatible(Context& context, const Type& expr) const {
     if (same(context, expr)) return true;
     if (auto expr_string = expr.is<ConstStringType>(); expr_string && expr_string->size == 1)
@@ -100,30 +106,13 @@ Maybe<TypePtr> TypeName::dereference(Context& context) const {
         return symbol->type;
 }
 
-Maybe<TypePtr> TypeName::normalize(Context& context, bool) const {
+Maybe<TypePtr> TypeName::do_normalize(Context& context, bool) const {
     auto symbol = context.symbols.get_symbol(context.messages, ident);
     if (!symbol)
         return error;
     return symbol->type;
 }
 
-bool TypeName::same(Context& context, const Type& other) const {
-    auto this_type = dereference(context);
-    if (!this_type) return berror;
-    const Type* other_type = &other;
-    if (auto other_name = other.is<TypeName>(); other_name) {
-        if (ident == other_name->ident) return true;
-        auto maybe_other_type = other_name->dereference(context);
-        if (!maybe_other_type) return berror;
-        other_type = maybe_other_type.value().get();
-    }
-    return this_type.value()->same(context, *other_type);
-}
-
-bool TypeName::equal(Context& context, const Type& other) const {
-    return same(context, other);
-}
-
 bool TypeName::assignment_compatible(Context& context, const Type& expr) const {
     auto this_type = dereference(context);
     if (!this_type) return berror;
@@ -140,22 +129,10 @@ std::string ImportTypeName::to_string() const {
     return fmt::format("${}", ident);
 }
 
-Maybe<TypePtr> ImportTypeName::normalize(Context&, bool) const {
+Maybe<TypePtr> ImportTypeName::do_normalize(Context&, bool) const {
     return make_type<ImportTypeName>(*this);
 }
 
-bool ImportTypeName::same(Context& context, const Type& other) const {
-    if (auto import_name = other.is<ImportTypeName>(); import_name) {
-        return ident == import_name->ident;
-    } else {
-        return other.same(context, *this);
-    }
-}
-
-bool ImportTypeName::equal(Context& context, const Type& other) const {
-    return same(context, other);
-}
-
 bool ImportTypeName::assignment_compatible(Context& context, const Type& expr) const {
     return equal(context, expr);
 }
@@ -168,45 +145,29 @@ std::string RecordType::to_string() const {
 }
 
 Maybe<TypePtr> RecordType::has_field(const Ident& ident, Context& context) const {
-    for (auto& list : seq) {
-        auto res = std::find_if(list.list.begin(), list.list.end(), [&ident](auto i) { return i.ident == ident; });
-        if (res != list.list.end()) {
-            return TypePtr(list.type);
-        }
-    }
-    if (basetype) {
-        auto base = context.symbols.get_symbol(context.messages, *basetype);
-        if (!base)
-            return error;
-        else {
-            auto baseptr = dynamic_cast<RecordType*>(base->type.get());
-            if (!baseptr) {
-                context.messages.addErr(basetype->ident.place, "Internal compiler error in RecordType::has_field");
-                return error;
-            }
-            return baseptr->has_field(ident, context);
-        }
-    }
-    context.messages.addErr(place, "Field {} not found in {}", ident, this->to_string());
-    return error;
+    return with_interner([&](TypeInterner& interner) -> Maybe<TypePtr> {
+        auto table = interner.fields(context, *this);
+        if (!table) return error;
+        if (auto field = table->find(ident); field) return field->type;
+        context.messages.addErr(place, "Field {} not found in {}", ident, *this);
+        return error;
+    });
 }
 
 bool RecordType::extends(Context& context, const Type& type) const {
-    auto typeRes = type.is<RecordType>();
-    if (!typeRes) return false;
-    if (this->same(context, *typeRes)) return true;
-    if (!basetype) return false;
-    auto res = context.symbols.get_symbol(context.messages, *basetype);
-    if (!res) internal::compiler_error("Basetype symbol not found");
-    if (res->type->same(context, *typeRes)) return true;
-    else {
-        auto record = res->type->is<RecordType>();
-        if (!record) internal::compiler_error("Basetype is not record type");
-        return record->extends(context, type);
-    }
-}
-
-Maybe<TypePtr> RecordType::normalize(Context& context, bool normalize_pointers) const {
+    auto base = type.is<RecordType>();
+    if (!base) return false;
+    if (base == this) return true;
+    return with_interner([&](TypeInterner& interner) {
+        auto display = interner.display(context, *this);
+        auto base_display = interner.display(context, *base);
+        if (!display || !base_display) internal::compiler_error("Basetype symbol not found");
+        auto level = base_display->size() - 1;
+        return level < display->size() && (*display)[level] == base_display->back();
+    });
+}
+
+Maybe<TypePtr> RecordType::do_normalize(Context& context, bool normalize_pointers) const {
     RecordType copy = *this;
     for (auto& list : copy.seq) {
         auto res = list.type->normalize(context, normalize_pointers);
@@ -217,15 +178,6 @@ Maybe<TypePtr> RecordType::normalize(Context& context, bool normalize_pointers)
     return make_type<RecordType>(copy);
 }
 
-bool RecordType::same(Context& context, const Type& other) const {
-    if (other.is<TypeName>()) return other.same(context, *this);
-    return this == &other;
-}
-
-bool RecordType::equal(Context& context, const Type& other) const {
-    return same(context, other);
-}
-
 bool RecordType::assignment_compatible(Context& context, const Type& expr) const {
     if (auto expr_record = expr.is<RecordType>(); expr_record) {
         return expr_record->extends(context, *this);
@@ -258,7 +210,7 @@ const RecordType& PointerType::get_type(Context& context) const {
     return *record;
 }
 
-Maybe<TypePtr> PointerType::normalize(Context& context, bool normalize_pointers) const {
+Maybe<TypePtr> PointerType::do_normalize(Context& context, bool normalize_pointers) const {
     if (!normalize_pointers)
         return make_type<PointerType>(*this);
     PointerType copy = *this;
@@ -267,15 +219,6 @@ Maybe<TypePtr> PointerType::normalize(Context& context, bool normalize_pointers)
     return make_type<PointerType>(copy);
 }
 
-bool PointerType::same(Context& context, const Type& other) const {
-    if (other.is<TypeName>()) return other.same(context, *this);
-    return this == &other;
-}
-
-bool PointerType::equal(Context& context, const Type& other) const {
-    return same(context, other);
-}
-
 bool PointerType::assignment_compatible(Context& context, const Type& expr) const {
     if (auto expr_pointer = expr.is<PointerType>(); expr_pointer) {
         auto& expr_type = expr_pointer->get_type(context);
@@ -288,22 +231,10 @@ bool PointerType::assignment_compatible(Context& context, const Type& expr) cons
 
 std::string ConstStringType::to_string() const { return fmt::format("String[{}]", size); }
 
-Maybe<TypePtr> ConstStringType::normalize(Context&, bool) const {
+Maybe<TypePtr> ConstStringType::do_normalize(Context&, bool) const {
     return make_type<ConstStringType>(*this);
 }
 
-bool ConstStringType::same(Context& context, const Type& other) const {
-    if (auto string = other.is<ConstStringType>(); string) {
-        return size == string->size;
-    } else {
-        return other.same(context, *this);
-    }
-}
-
-bool ConstStringType::equal(Context& context, const Type& other) const {
-    return same(context, other);
-}
-
 bool ConstStringType::assignment_compatible(Context&, const Type&) const {
     return false;
 }
@@ -316,7 +247,7 @@ std::string ArrayType::to_string() const {
     }
 }
 
-Maybe<TypePtr> ArrayType::normalize(Context& context, bool normalize_pointers) const {
+Maybe<TypePtr> ArrayType::do_normalize(Context& context, bool normalize_pointers) const {
     ArrayType copy = *this;
     auto res = copy.type->normalize(context, normalize_pointers);
     if (!res)
@@ -326,7 +257,7 @@ Maybe<TypePtr> ArrayType::normalize(Context& context, bool normalize_pointers) c
         auto expr = copy.length.get(context);
         if (!expr)
             return error;
-        auto integer = dynamic_cast<IntegerValue*>(expr->get());
+        auto integer = dyn_cast<IntegerValue>(expr->get());
         if (!integer) {
             context.messages.addErr(expr.value()->place, "Expected integer");
             return error;
@@ -335,22 +266,6 @@ Maybe<TypePtr> ArrayType::normalize(Context& context, bool normalize_pointers) c
     return make_type<ArrayType>(copy);
 }
 
-bool ArrayType::same(Context& context, const Type& other) const {
-    if (other.is<TypeName>()) return other.same(context, *this);
-    return this == &other;
-}
-
-bool ArrayType::equal(Context& context, const Type& other) const {
-    if (auto other_array = other.is<ArrayType>(); other_array && open_array && other_array->open_array) {
-        return type->equal(context, *other_array->type);
-    } else if (auto other_name = other.is<TypeName>(); other_name) {
-        auto other_type = other_name->dereference(context);
-        if (!other_type) return berror;
-        return equal(context, *other_type.value());
-    }
-    return false;
-}
-
 bool ArrayType::assignment_compatible(Context& context, const Type& expr) const {
     if (auto expr_string = expr.is<ConstStringType>(); expr_string) {
         auto array_type = type->is<BuiltInType>();
@@ -396,7 +311,7 @@ bool ArrayType::compatible(Context& context, const Type& actual, const Type& for
     return false;
 }
 
-ArrayType::ArrayType(std::vector<ExpressionPtr> l, TypePtr t, bool u) : open_array(u) {
+ArrayType::ArrayType(std::vector<ExpressionPtr> l, TypePtr t, bool u) : Type(node_kind), open_array(u) {
     length = l.front();
     if (l.size() > 1) {
         type = make_type<ArrayType>(std::vector(l.begin() + 1, l.end()), t, u);
@@ -433,7 +348,7 @@ std::string ProcedureType::to_string() const {
     return fmt::format("PROCEDURE {}", params);
 }
 
-Maybe<TypePtr> ProcedureType::normalize(Context& context, bool normalize_pointers) const {
+Maybe<TypePtr> ProcedureType::do_normalize(Context& context, bool normalize_pointers) const {
     ProcedureType type = *this;
     if (type.params.rettype) {
         auto new_ret_type = type.params.rettype.value()->normalize(context, normalize_pointers);
@@ -463,22 +378,6 @@ Maybe<TypePtr> ProcedureType::normalize(Context& context, bool normalize_pointer
     return make_type<ProcedureType>(type);
 }
 
-bool ProcedureType::same(Context& context, const Type& other) const {
-    if (other.is<TypeName>()) return other.same(context, *this);
-    return this == &other;
-}
-
-bool ProcedureType::equal(Context& context, const Type& other) const {
-    if (auto other_procedure = other.is<ProcedureType>(); other_procedure) {
-        return params.match(context, other_procedure->params, true, true);
-    } else if (auto other_name = other.is<TypeName>(); other_name) {
-        auto other_type = other_name->dereference(context);
-        if (!other_type) return berror;
-        return equal(context, *other_type.value());
-    }
-    return false;
-}
-
 bool ProcedureType::assignment_compatible(Context& context, const Type& expr) const {
     if (auto expr_procedure = expr.is<ProcedureType>(); expr_procedure) {
         return params.match(context, expr_procedure->params, true, true);
@@ -488,7 +387,7 @@ bool ProcedureType::assignment_compatible(Context& context, const Type& expr) co
     return same(context, expr);
 }
 
-ProcedureType::ProcedureType(std::optional<FormalParameters> par) {
+ProcedureType::ProcedureType(std::optional<FormalParameters> par) : Type(node_kind) {
     if (par)
         params = *par;
 }
@@ -499,7 +398,7 @@ std::string CommonType::to_string() const {
                        else_clause ? fmt::format(" ELSE {}", else_clause.value()->to_string()) : "");
 }
 
-Maybe<TypePtr> CommonType::normalize(Context& context, bool normalize_pointers) const {
+Maybe<TypePtr> CommonType::do_normalize(Context& context, bool normalize_pointers) const {
     CommonType copy;
     copy.common_feature_type = common_feature_type;
     //Проверка на то что все варианты имеют один тип метки
@@ -534,11 +433,6 @@ Maybe<TypePtr> CommonType::normalize(Context& context, bool normalize_pointers)
     return make_type<CommonType>(copy);
 }
 
-bool CommonType::same(Context& context, const Type& other) const {
-    if (other.is<TypeName>()) return other.same(context, *this);
-    return this == &other;
-}
-
 bool CommonType::equal(Context& context, const Type& other) const {
     if (auto scalar_other = other.is<ScalarType>(); scalar_other) {
         return equal(context, *scalar_other->type);
@@ -570,27 +464,22 @@ std::string ScalarType::to_string() const {
     return fmt::format("({})<{}>", type->to_string(), feature);
 }
 
-Maybe<TypePtr> ScalarType::normalize(Context& context, bool normalize_pointers) const {
+Maybe<TypePtr> ScalarType::do_normalize(Context& context, bool normalize_pointers) const {
     ScalarType copy;
     copy.feature = feature;
     auto new_type = type->normalize(context, normalize_pointers);
     if (!new_type) return error;
     if (auto common_type = new_type.value()->is<CommonType>(); !common_type) {
-        context.messages.addErr(type->place, "Expected CommonType, found: {}", new_type.value()->to_string());
+        context.messages.addErr(type->place, "Expected CommonType, found: {}", **new_type);
         return error;
     } else if (!common_type->has_case(feature)) {
-        context.messages.addErr(place, "Feature with name {}, not found in {}", feature, type->to_string());
+        context.messages.addErr(place, "Feature with name {}, not found in {}", feature, *type);
         return error;
     }
     copy.type = new_type.value();
     return make_type<ScalarType>(copy);
 }
 
-bool ScalarType::same(Context& context, const Type& other) const {
-    if (other.is<TypeName>()) return other.same(context, *this);
-    return this == &other;
-}
-
 bool ScalarType::equal(Context& context, const Type& other) const {
     if (auto scalar_other = other.is<ScalarType>(); scalar_other) {
         return type->same(context, *scalar_other->type) && feature == scalar_other->feature;
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""Compiles a fixture module and compares the compiler diagnostics and output with the expected ones.
+
+Usage: run_fixture.py COMPILER MODULE EXPECTED [--section=TITLE] [OPTION...]
+Modules are looked up relative to the working directory, so the test runs in the directory of the fixture.
+Diagnostics come first; terminal colors are removed from both streams.
+With --section only the line TITLE and the indented lines following it are compared, for reports such as
+--stats whose other parts depend on the build. The remaining options are passed to the compiler.
+"""
+import difflib
+import re
+import subprocess
+import sys
+
+COLOR = re.compile(r'\x1b\[[0-9;]*m')
+
+
+def section(output, title):
+    lines = output.splitlines(True)
+    if title + '\n' not in lines:
+        return ''
+    start = lines.index(title + '\n')
+    end = start + 1
+    while end < len(lines) and lines[end].startswith(' '):
+        end += 1
+    return ''.join(lines[start:end])
+
+
+def main():
+    if len(sys.argv) < 4:
+        print(__doc__, file=sys.stderr)
+        return 2
+    compiler, module, expected_file = sys.argv[1:4]
+    options = [option for option in sys.argv[4:] if not option.startswith('--section=')]
+    titles = [option[len('--section='):] for option in sys.argv[4:] if option.startswith('--section=')]
+    result = subprocess.run([compiler, *options, module], capture_output=True, text=True)
+    output = COLOR.sub('', result.stderr + result.stdout)
+    if titles:
+        output = ''.join(section(output, title) for title in titles)
+    with open(expected_file) as file:
+        expected = file.read()
+    if result.returncode == 0 and output == expected:
+        return 0
+    sys.stdout.writelines(difflib.unified_diff(expected.splitlines(True), output.splitlines(True),
+                                               expected_file, module))
+    return 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())